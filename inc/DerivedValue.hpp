@@ -0,0 +1,74 @@
+#ifndef DERIVEDVALUE_HPP
+#define DERIVEDVALUE_HPP
+
+#include <stdint.h>
+
+#define DERIVEDVALUE_DEFAULT_IMPEDANCE 600.0f /*!< Default dBm reference impedance, in ohms */
+
+typedef struct {
+    float delta;   /*!< Deviation from relative value, as displayed in relative mode */
+    float percent; /*!< Deviation from relative value, in percent */
+    float dbRel;   /*!< Absolute reading relative to relative value, in dB */
+    float level;   /*!< In dB mode: voltage corresponding to absolute reading. Otherwise: absolute reading in dBm. */
+} derived_value_t;
+
+/**
+ * Computes values derived from each reading. Logarithms are done using the
+ * fixlog tables, and terms depending only on the relative value are only
+ * recomputed when it changes, so the cost per reading is bounded and small
+ * enough to run at the full decode rate.
+ *
+ * In relative mode the 8050A already displays the reading minus the relative
+ * value, so the absolute reading is recovered by adding the relative value
+ * back.
+ *
+ * Unavailable values are set to NAN.
+ *
+ * update() may run in interrupt context on one core while get() runs on
+ * another, so values are published through a sequence counter and get()
+ * retries until it sees a consistent copy.
+ */
+class DerivedValue {
+private:
+    derived_value_t   values;     /*!< Most recently computed values */
+    volatile uint32_t seq;        /*!< Incremented before and after values is written, odd while writing */
+
+    float             relative;   /*!< Relative value that relInverse and relLog2 are computed for */
+    float             relInverse; /*!< 100 / relative, NAN if relative is 0 */
+    int32_t           relLog2;    /*!< log2(|relative|), Q16.16 */
+
+    int32_t           refLog2;    /*!< log2 of dBm reference voltage, Q16.16 */
+
+public:
+    /**
+     * Constructor
+     */
+    DerivedValue(void);
+
+    /**
+     * Set the reference impedance used for dBm. Should match the setting on
+     * the 8050A.
+     *
+     * @param ohms Reference impedance, in ohms
+     */
+    void setImpedance(float ohms);
+
+    /**
+     * Compute derived values for a new reading.
+     *
+     * @param value    Reading, as displayed
+     * @param relative Relative value, NAN if not in relative mode
+     * @param dB       Whether the reading is in dBm
+     */
+    void update(float value, float relative, bool dB);
+
+    /**
+     * Get the most recently computed values. Safe to call while update() may
+     * be running on another core or in an interrupt.
+     *
+     * @param out Where to store values
+     */
+    void get(derived_value_t *out);
+};
+
+#endif
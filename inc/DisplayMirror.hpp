@@ -0,0 +1,137 @@
+#ifndef DISPLAYMIRROR_HPP
+#define DISPLAYMIRROR_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <uart.h>
+
+#include <NT35310.hpp>
+
+/**
+ * Mirrors an indexed framebuffer to a host over UART, for viewing with
+ * tools/mirror.py.
+ *
+ * The screen is split into tiles. Only tiles that differ from the copy last
+ * sent are transmitted, as the XOR against that copy compressed with PackBits
+ * RLE, so bandwidth depends on how much of the screen changes.
+ *
+ * Frame format:
+ *   SYNC0, SYNC1, type (u8), length (u16), payload, checksum (u8)
+ * All values little-endian, checksum is the XOR of type, length and payload
+ * bytes.
+ *
+ * The host may send:
+ *   XOFF/XON - Pause/resume transmission
+ *   'K'      - Request a full resend (keyframe)
+ */
+
+#define DISPLAYMIRROR_SYNC0 0xA5
+#define DISPLAYMIRROR_SYNC1 0xC3
+
+#define DISPLAYMIRROR_TILE  16    /*!< Tile width and height, in pixels */
+
+#define DISPLAYMIRROR_XON   0x11
+#define DISPLAYMIRROR_XOFF  0x13
+#define DISPLAYMIRROR_KEY   'K'
+
+typedef enum {
+    DISPLAYMIRROR_FRAME_INFO    = 0x01, /* width (u16), height (u16), bpp (u8), tile (u8), 18-bit color (u8). Host clears screen. */
+    DISPLAYMIRROR_FRAME_PALETTE = 0x02, /* count (u16), entries (u32) in display format */
+    DISPLAYMIRROR_FRAME_TILE    = 0x03, /* tile x (u16), tile y (u16), RLE of XOR with previous tile contents */
+    DISPLAYMIRROR_FRAME_END     = 0x04  /* All changes up to this point sent */
+} displaymirror_frame_e;
+
+class DisplayMirror {
+private:
+    uart_device_number_t uartDev;   /*!< UART to send over */
+    uint32_t             baud;      /*!< UART baud rate */
+
+    uint8_t              bpp;       /*!< Bits per pixel of framebuffer */
+    uint16_t             width;     /*!< Width of framebuffer, in pixels */
+    uint16_t             height;    /*!< Height of framebuffer, in pixels */
+    uint16_t             rowBytes;  /*!< Bytes per framebuffer row */
+
+    uint8_t             *shadow;    /*!< Framebuffer contents as last sent, rowBytes * height */
+    uint32_t             shadowPalette[256]; /*!< Palette as last sent */
+    uint8_t              frame[2 + (4 * 256)]; /*!< Payload buffer, sized for largest frame (palette) */
+    bool                 needInfo;  /*!< Whether an INFO frame must be sent before anything else */
+    bool                 paused;    /*!< Host has sent XOFF */
+    uint32_t             nextTile;  /*!< Tile to resume scanning from, row-major index */
+    bool                 endPending; /*!< Changes were sent since the last END frame */
+
+    uint32_t             bytesSent; /*!< Total bytes sent, for statistics */
+
+    /**
+     * Handle any flow control or requests from the host.
+     */
+    void poll(void);
+
+    /**
+     * Forget what was last sent, so the host's copy is rebuilt from scratch.
+     */
+    void resync(void);
+
+    /**
+     * Send a single frame.
+     *
+     * @param type    Frame type
+     * @param payload Payload data
+     * @param len     Length of payload
+     */
+    void sendFrame(displaymirror_frame_e type, const uint8_t *payload, uint16_t len);
+
+    /**
+     * Compress data using PackBits.
+     *
+     * @param dest Destination buffer, must hold at least len + (len + 127) / 128 bytes
+     * @param src  Data to compress
+     * @param len  Length of data
+     *
+     * @return Length of compressed data
+     */
+    static size_t packBits(uint8_t *dest, const uint8_t *src, size_t len);
+
+public:
+    /**
+     * Constructor
+     *
+     * @param uartDev UART to send over
+     * @param baud    UART baud rate
+     * @param bpp     Bits per pixel of framebuffer
+     * @param width   Width of framebuffer, in pixels
+     * @param height  Height of framebuffer, in pixels
+     * @param shadow  Buffer to hold copy of last sent contents, must be the
+     *                same size as the framebuffer
+     */
+    DisplayMirror(uart_device_number_t uartDev, uint32_t baud, uint8_t bpp,
+                  uint16_t width, uint16_t height, uint8_t *shadow);
+
+    /**
+     * Initialize UART. UART pins must already be configured.
+     */
+    void init(void);
+
+    /**
+     * Send changes since the last update. END follows once a scan of the
+     * whole screen completes within the budget, covering everything sent
+     * since the previous END.
+     *
+     * @param pixels   Framebuffer contents, packed palette indices with
+     *                 byte-aligned rows
+     * @param palette  Framebuffer palette, 2^bpp entries
+     * @param maxBytes Stop after sending approximately this many bytes,
+     *                 remaining changes are sent on later updates, starting
+     *                 from the tile after the last one sent. Sending is
+     *                 polled, so this also bounds how long the call blocks:
+     *                 at most maxBytes plus one tile frame at the line rate.
+     */
+    void update(const uint8_t *pixels, const nt35310_pixel_t *palette, size_t maxBytes);
+
+    /**
+     * @return Total number of bytes sent
+     */
+    uint32_t getBytesSent(void);
+};
+
+#endif
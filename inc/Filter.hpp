@@ -0,0 +1,310 @@
+#ifndef FILTER_HPP
+#define FILTER_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Allocation-free filters for smoothing readings. Samples are signed
+ * fixed-point values with FILTER_FRAC_BITS fractional bits, so that the
+ * averaging filters can keep sub-count resolution.
+ *
+ * Each stage provides:
+ *   int32_t process(int32_t in) - Filter a sample, returning the output
+ *   void    reset(void)         - Clear any history
+ *
+ * Stages are combined at compile time with FilterChain, and individual stages
+ * can be bypassed at runtime.
+ */
+
+#define FILTER_FRAC_BITS 8
+#define FILTER_ONE       (1 << FILTER_FRAC_BITS)
+
+/**
+ * Boxcar moving average over the last N samples, using a running sum.
+ */
+template<uint16_t N>
+class FilterMovingAverage {
+    static_assert(N > 0, "Window must not be empty");
+
+private:
+    int32_t  window[N]; /*!< Last N samples, circular */
+    int64_t  sum;       /*!< Sum of samples in window */
+    uint16_t pos;       /*!< Next position to write in window */
+    uint16_t count;     /*!< Number of valid samples in window */
+
+public:
+    FilterMovingAverage(void) {
+        this->reset();
+    }
+
+    void reset(void) {
+        this->sum   = 0;
+        this->pos   = 0;
+        this->count = 0;
+    }
+
+    int32_t process(int32_t in) {
+        if(this->count < N) {
+            this->count++;
+        } else {
+            this->sum -= this->window[this->pos];
+        }
+        this->window[this->pos] = in;
+        this->sum += in;
+        this->pos  = (this->pos + 1) % N;
+
+        return (int32_t)(this->sum / this->count);
+    }
+};
+
+/**
+ * Median of the last N samples. A sorted copy of the window is updated
+ * incrementally, by removing the oldest sample and inserting the newest.
+ */
+template<uint16_t N>
+class FilterMedian {
+    static_assert(N > 0, "Window must not be empty");
+
+private:
+    int32_t  window[N]; /*!< Last N samples, circular */
+    int32_t  sorted[N]; /*!< Samples in window, sorted ascending */
+    uint16_t pos;       /*!< Next position to write in window */
+    uint16_t count;     /*!< Number of valid samples in window */
+
+public:
+    FilterMedian(void) {
+        this->reset();
+    }
+
+    void reset(void) {
+        this->pos   = 0;
+        this->count = 0;
+    }
+
+    int32_t process(int32_t in) {
+        uint16_t i;
+
+        if(this->count < N) {
+            i = this->count++;
+        } else {
+            /* Remove oldest sample, leaving a hole at i */
+            int32_t old = this->window[this->pos];
+            for(i = 0; this->sorted[i] != old; i++);
+            for(; i < (N - 1); i++) {
+                this->sorted[i] = this->sorted[i + 1];
+            }
+        }
+
+        /* Insert new sample, shifting larger values up into the hole */
+        while((i > 0) && (this->sorted[i - 1] > in)) {
+            this->sorted[i] = this->sorted[i - 1];
+            i--;
+        }
+        this->sorted[i] = in;
+
+        this->window[this->pos] = in;
+        this->pos = (this->pos + 1) % N;
+
+        return this->sorted[this->count / 2];
+    }
+};
+
+/**
+ * Exponential smoothing, with a coefficient of 2^-SHIFT.
+ */
+template<uint8_t SHIFT>
+class FilterExponential {
+    static_assert(SHIFT < 32, "Shift too large");
+
+private:
+    int64_t state;  /*!< Current output, with SHIFT extra fractional bits */
+    bool    primed; /*!< Whether state holds a valid value */
+
+public:
+    FilterExponential(void) {
+        this->reset();
+    }
+
+    void reset(void) {
+        this->primed = false;
+    }
+
+    int32_t process(int32_t in) {
+        if(!this->primed) {
+            this->state  = (int64_t)in << SHIFT;
+            this->primed = true;
+        } else {
+            this->state += in - (this->state >> SHIFT);
+        }
+
+        return (int32_t)(this->state >> SHIFT);
+    }
+};
+
+/**
+ * Detects when the input has settled, i.e. the last N samples all lie within
+ * TOLERANCE of each other. Samples are passed through unmodified.
+ */
+template<uint16_t N, int32_t TOLERANCE>
+class FilterSettle {
+    static_assert(N > 0, "Window must not be empty");
+
+private:
+    int32_t  window[N]; /*!< Last N samples, circular */
+    uint16_t pos;       /*!< Next position to write in window */
+    uint16_t count;     /*!< Number of valid samples in window */
+    bool     settled;   /*!< Whether the window was full and within TOLERANCE */
+
+public:
+    FilterSettle(void) {
+        this->reset();
+    }
+
+    void reset(void) {
+        this->pos     = 0;
+        this->count   = 0;
+        this->settled = false;
+    }
+
+    int32_t process(int32_t in) {
+        this->window[this->pos] = in;
+        this->pos = (this->pos + 1) % N;
+        if(this->count < N) {
+            this->count++;
+        }
+
+        this->settled = false;
+        if(this->count == N) {
+            int32_t low  = in;
+            int32_t high = in;
+            for(uint16_t i = 0; i < N; i++) {
+                if(this->window[i] < low)  { low  = this->window[i]; }
+                if(this->window[i] > high) { high = this->window[i]; }
+            }
+            this->settled = ((int64_t)high - low) <= TOLERANCE;
+        }
+
+        return in;
+    }
+
+    /**
+     * @return true if the last N samples were within TOLERANCE
+     */
+    bool isSettled(void) {
+        return this->settled;
+    }
+};
+
+/**
+ * Recursive storage for FilterChain stages.
+ */
+template<typename... Stages>
+struct FilterStages {
+    int32_t process(int32_t in, uint32_t enabled) {
+        (void)enabled;
+        return in;
+    }
+
+    void reset(void) {}
+};
+
+template<typename First, typename... Rest>
+struct FilterStages<First, Rest...> {
+    First                 head;
+    FilterStages<Rest...> tail;
+
+    int32_t process(int32_t in, uint32_t enabled) {
+        if(enabled & 1) {
+            in = this->head.process(in);
+        }
+        return this->tail.process(in, enabled >> 1);
+    }
+
+    void reset(void) {
+        this->head.reset();
+        this->tail.reset();
+    }
+};
+
+template<size_t I>
+struct FilterStageIndex {
+    template<typename T>
+    static auto &get(T &stages) {
+        return FilterStageIndex<I - 1>::get(stages.tail);
+    }
+};
+
+template<>
+struct FilterStageIndex<0> {
+    template<typename T>
+    static auto &get(T &stages) {
+        return stages.head;
+    }
+};
+
+/**
+ * Chain of filter stages, applied in order.
+ */
+template<typename... Stages>
+class FilterChain {
+    static_assert(sizeof...(Stages) <= 32, "Too many stages");
+
+private:
+    FilterStages<Stages...> stages;  /*!< Filter stages */
+    uint32_t                enabled; /*!< Bitmask of enabled stages, LSB is first stage */
+
+public:
+    FilterChain(void) {
+        this->enabled = (uint32_t)((1ULL << sizeof...(Stages)) - 1);
+    }
+
+    /**
+     * Filter a sample through all enabled stages.
+     *
+     * @param in Input sample
+     *
+     * @return Filtered sample
+     */
+    int32_t process(int32_t in) {
+        return this->stages.process(in, this->enabled);
+    }
+
+    /**
+     * Clear history of all stages. Should be called when the input changes in
+     * a way that makes previous samples meaningless, such as a range change.
+     */
+    void reset(void) {
+        this->stages.reset();
+    }
+
+    /**
+     * Select which stages are applied. Resets all stages.
+     *
+     * @param mask Bitmask of stages to enable, LSB is first stage
+     */
+    void setEnabled(uint32_t mask) {
+        this->enabled = mask;
+        this->reset();
+    }
+
+    /**
+     * @return Bitmask of enabled stages
+     */
+    uint32_t getEnabled(void) {
+        return this->enabled;
+    }
+
+    /**
+     * Access an individual stage, e.g. to query a FilterSettle.
+     *
+     * @tparam I Index of stage
+     */
+    template<size_t I>
+    auto &stage(void) {
+        static_assert(I < sizeof...(Stages), "Stage index out of range");
+        return FilterStageIndex<I>::get(this->stages);
+    }
+};
+
+#endif
@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 
+#include <DerivedValue.hpp>
+
 typedef struct {
     uint8_t dp;   /*!< Decimal point / relative */
     uint8_t hv;   /*!< High Voltage */
@@ -39,9 +41,16 @@ private:
     uint8_t            decimal;    /*!< Position of decimal point, 0xFF in non-existant */
 
     float              value;      /*!< Last displayed numberical value */
+    int16_t            counts;     /*!< Last displayed value, ignoring decimal point */
+    float              scale;      /*!< Divisor to convert counts to value */
     float              relaPend;   /*!< Pending relative value */
     float              relative;   /*!< Last recorded value when relative mode was enabled */
 
+    volatile uint32_t  samples;    /*!< Number of readings successfully converted */
+    volatile uint32_t  seq;        /*!< Incremented before and after value, counts, scale and samples are written, odd while writing */
+
+    DerivedValue       derived;    /*!< Values derived from each reading */
+
     /**
      * Convert received and stored data into numerical value.
      * 
@@ -97,6 +106,30 @@ public:
      */
     float getValue(void);
     
+    /**
+     * Get the last seen value as an integer, ignoring the decimal point.
+     * 
+     * @return Last seen value in counts
+     * 
+     * @see getScale
+     */
+    int16_t getCounts(void);
+
+    /**
+     * Get the divisor that converts counts into the displayed value. Changes
+     * with the range.
+     * 
+     * @return Divisor for last seen value
+     */
+    float getScale(void);
+
+    /**
+     * Get the current status indicators.
+     * 
+     * @return Status bits, see fluke_8050a_status_e
+     */
+    uint8_t getStatus(void);
+
     /**
      * Get the current relative value, if applicable.
      * 
@@ -106,7 +139,42 @@ public:
     float getRelative(void);
 
     /**
-     * Print some internal state to the serial port for debugging purposes.
+     * Get the number of readings converted so far. Can be polled to detect
+     * when a new reading is available.
+     * 
+     * @return Number of readings converted since init
+     */
+    uint32_t getSampleCount(void);
+
+    /**
+     * Get the last seen value in counts along with its scale, as a consistent
+     * pair. Safe to call from core 1 while core 0 is decoding, unlike separate
+     * calls to getCounts and getScale, which may straddle a range change.
+     * 
+     * @param counts Where to store last seen value in counts
+     * @param scale  Where to store divisor for last seen value
+     * 
+     * @return Number of readings converted since init, including this one
+     */
+    uint32_t getReading(int16_t *counts, float *scale);
+
+    /**
+     * Get values derived from the last reading (relative delta, dB, etc.)
+     * 
+     * @param out Where to store derived values
+     */
+    void getDerived(derived_value_t *out);
+
+    /**
+     * Set the reference impedance used for dBm conversions. Should match the
+     * impedance selected on the 8050A.
+     * 
+     * @param ohms Reference impedance, in ohms
+     */
+    void setImpedance(float ohms);
+
+    /**
+     * Log some internal state for debugging purposes.
      */
     void debug(void);
 };
@@ -0,0 +1,210 @@
+#ifndef INDEXEDFRAMEBUFFER_HPP
+#define INDEXEDFRAMEBUFFER_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <NT35310.hpp>
+
+/**
+ * Framebuffer storing palette indices rather than colors. Pixels are packed
+ * most-significant bits first, and rows are byte-aligned.
+ *
+ * Modified regions are tracked as a dirty span per row. On flush, dirty spans
+ * are expanded through the palette into a small bounce buffer in display
+ * format and written to the display. Changing a palette entry redraws the
+ * whole screen, but costs no drawing work.
+ *
+ * @tparam BPP         Bits per pixel: 1, 2, 4 or 8
+ * @tparam WIDTH       Width in pixels
+ * @tparam HEIGHT      Height in pixels
+ * @tparam BOUNCE_ROWS Number of rows that fit in the bounce buffer
+ */
+template<uint8_t BPP, uint16_t WIDTH, uint16_t HEIGHT, uint16_t BOUNCE_ROWS = 8>
+class IndexedFramebuffer {
+    static_assert((BPP == 1) || (BPP == 2) || (BPP == 4) || (BPP == 8), "Unsupported bits per pixel");
+    static_assert(BOUNCE_ROWS > 0, "Bounce buffer must not be empty");
+
+public:
+    static const uint16_t ROW_BYTES = ((WIDTH * BPP) + 7) / 8; /*!< Bytes per row */
+    static const uint16_t COLORS    = (1U << BPP);             /*!< Number of palette entries */
+
+private:
+    static const uint8_t  PPB  = 8 / BPP;                      /*!< Pixels per byte */
+    static const uint8_t  MASK = (uint8_t)((1U << BPP) - 1);   /*!< Mask for single pixel */
+
+    uint8_t         pixels[ROW_BYTES * HEIGHT];  /*!< Palette indices */
+    nt35310_pixel_t palette[COLORS];             /*!< Palette, in display format */
+
+    uint16_t        dirtyX1[HEIGHT];             /*!< First dirty pixel in each row */
+    uint16_t        dirtyX2[HEIGHT];             /*!< Last dirty pixel in each row, less than dirtyX1 if row is clean */
+
+    alignas(NT35310_BUFFER_ALIGN)
+    nt35310_pixel_t bounce[((WIDTH * BOUNCE_ROWS) + 1) & ~1]; /*!< Expanded pixels, waiting to be sent to display. Rounded up to whole pixel pairs. */
+
+    void setPixelRaw(uint16_t x, uint16_t y, uint8_t idx) {
+        uint8_t *byte  = &this->pixels[(y * ROW_BYTES) + (x / PPB)];
+        uint8_t  shift = (uint8_t)(8 - (BPP * ((x % PPB) + 1)));
+        *byte = (uint8_t)((*byte & ~(MASK << shift)) | ((idx & MASK) << shift));
+    }
+
+    /**
+     * Expand part of a row through the palette into the bounce buffer.
+     *
+     * @param pos Index of first bounce buffer pixel to write
+     */
+    void expand(size_t pos, uint16_t y, uint16_t x1, uint16_t x2) {
+        const uint8_t *row = &this->pixels[y * ROW_BYTES];
+        for(uint16_t x = x1; x <= x2; x++) {
+            uint8_t shift = (uint8_t)(8 - (BPP * ((x % PPB) + 1)));
+            this->bounce[NT35310_PIXEL_INDEX(pos++)] = this->palette[(row[x / PPB] >> shift) & MASK];
+        }
+    }
+
+public:
+    IndexedFramebuffer(void) {
+        for(size_t i = 0; i < sizeof(this->pixels); i++) {
+            this->pixels[i] = 0;
+        }
+        for(uint16_t i = 0; i < COLORS; i++) {
+            this->palette[i] = 0;
+        }
+        for(uint16_t i = 0; i < HEIGHT; i++) {
+            this->dirtyX1[i] = 1;
+            this->dirtyX2[i] = 0;
+        }
+        this->markDirty(0, 0, WIDTH - 1, HEIGHT - 1);
+    }
+
+    uint16_t getWidth(void) {
+        return WIDTH;
+    }
+
+    uint16_t getHeight(void) {
+        return HEIGHT;
+    }
+
+    uint8_t getBpp(void) {
+        return BPP;
+    }
+
+    /**
+     * @return Packed palette indices, ROW_BYTES per row
+     */
+    const uint8_t *getPixels(void) {
+        return this->pixels;
+    }
+
+    /**
+     * @return Palette, COLORS entries in display format
+     */
+    const nt35310_pixel_t *getPalette(void) {
+        return this->palette;
+    }
+
+    /**
+     * Set a palette entry. If the color changes, the whole display is redrawn
+     * on the next flush.
+     *
+     * @param idx   Palette index
+     * @param color Color, in the format of the display
+     */
+    void setPalette(uint8_t idx, nt35310_pixel_t color) {
+        if(idx >= COLORS) {
+            return;
+        }
+        if(this->palette[idx] != color) {
+            this->palette[idx] = color;
+            this->markDirty(0, 0, WIDTH - 1, HEIGHT - 1);
+        }
+    }
+
+    /**
+     * Mark a region as needing to be written to the display.
+     */
+    void markDirty(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
+        if((x1 >= WIDTH) || (y1 >= HEIGHT) || (x1 > x2) || (y1 > y2)) {
+            return;
+        }
+        if(x2 >= WIDTH)  { x2 = WIDTH - 1;  }
+        if(y2 >= HEIGHT) { y2 = HEIGHT - 1; }
+
+        for(uint16_t y = y1; y <= y2; y++) {
+            if(this->dirtyX1[y] > this->dirtyX2[y]) {
+                this->dirtyX1[y] = x1;
+                this->dirtyX2[y] = x2;
+            } else {
+                if(x1 < this->dirtyX1[y]) { this->dirtyX1[y] = x1; }
+                if(x2 > this->dirtyX2[y]) { this->dirtyX2[y] = x2; }
+            }
+        }
+    }
+
+    void setPixel(uint16_t x, uint16_t y, uint8_t idx) {
+        if((x >= WIDTH) || (y >= HEIGHT)) {
+            return;
+        }
+        this->setPixelRaw(x, y, idx);
+        this->markDirty(x, y, x, y);
+    }
+
+    uint8_t getPixel(uint16_t x, uint16_t y) {
+        if((x >= WIDTH) || (y >= HEIGHT)) {
+            return 0;
+        }
+        uint8_t shift = (uint8_t)(8 - (BPP * ((x % PPB) + 1)));
+        return (this->pixels[(y * ROW_BYTES) + (x / PPB)] >> shift) & MASK;
+    }
+
+    /**
+     * Fill a rectangle with a palette index. Coordinates are inclusive.
+     */
+    void fillRect(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint8_t idx) {
+        if((x1 >= WIDTH) || (y1 >= HEIGHT) || (x1 > x2) || (y1 > y2)) {
+            return;
+        }
+        if(x2 >= WIDTH)  { x2 = WIDTH - 1;  }
+        if(y2 >= HEIGHT) { y2 = HEIGHT - 1; }
+
+        for(uint16_t y = y1; y <= y2; y++) {
+            for(uint16_t x = x1; x <= x2; x++) {
+                this->setPixelRaw(x, y, idx);
+            }
+        }
+        this->markDirty(x1, y1, x2, y2);
+    }
+
+    /**
+     * Write all dirty regions to the display. Consecutive rows with the same
+     * dirty span are combined into a single write.
+     *
+     * @param lcd Display to write to
+     */
+    void flush(NT35310 &lcd) {
+        uint16_t y = 0;
+        while(y < HEIGHT) {
+            uint16_t x1 = this->dirtyX1[y];
+            uint16_t x2 = this->dirtyX2[y];
+            if(x1 > x2) {
+                y++;
+                continue;
+            }
+
+            uint16_t w    = (x2 - x1) + 1;
+            uint16_t rows = 0;
+            while(((y + rows) < HEIGHT) && (rows < BOUNCE_ROWS) &&
+                  (this->dirtyX1[y + rows] == x1) &&
+                  (this->dirtyX2[y + rows] == x2)) {
+                this->expand((size_t)rows * w, y + rows, x1, x2);
+                this->dirtyX1[y + rows] = 1;
+                this->dirtyX2[y + rows] = 0;
+                rows++;
+            }
+
+            lcd.writeBuffer(this->bounce, w, rows, x1, y);
+            y += rows;
+        }
+    }
+};
+
+#endif
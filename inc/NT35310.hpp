@@ -1,6 +1,7 @@
 #ifndef NT35310_HPP
 #define NT35310_HPP
 
+#include <stdint.h>
 #include <spi.h>
 
 /**
@@ -11,18 +12,36 @@
 #define NT35310_18BIT_COLOR 0
 
 #if (NT35310_18BIT_COLOR)
+typedef uint32_t nt35310_pixel_t; /*!< Single pixel, in display format */
 #define RGB(R, G, B) ((((uint32_t)(R) & 0xFC) << 16) | \
                       (((uint32_t)(G) & 0xFC) << 8)  | \
                       (((uint32_t)(B) & 0xFC)))
+#define NT35310_PIXEL_INDEX(i) (i)
 #else
+typedef uint16_t nt35310_pixel_t; /*!< Single pixel, in display format */
 #define RGB(R, G, B) ((((uint16_t)(R) & 0xF8) << 8) | \
                       (((uint16_t)(G) & 0xFC) << 3) | \
                       (((uint16_t)(B) & 0xF8) >> 3))
+#define NT35310_PIXEL_INDEX(i) ((i) ^ 1)
 #endif
 
+/**
+ * Pixel buffer layout.
+ *
+ * Pixel data is sent as 32-bit words straight from memory by DMA. In 16-bit
+ * mode each word holds two pixels, and as the SPI shifts out the upper half
+ * first, pixels are swapped within each pair: pixel i of a buffer is stored
+ * at index NT35310_PIXEL_INDEX(i). In 18-bit mode each word holds one pixel.
+ *
+ * Buffers must be aligned to NT35310_BUFFER_ALIGN bytes, and hold a whole
+ * number of pixel pairs.
+ */
+#define NT35310_BUFFER_ALIGN 4
+
 typedef enum {
     NT35310_CMD_NOP                    = 0x00,
     NT35310_CMD_SOFT_RESET             = 0x01, /* Labeled "SOFT_REST" in datasheet */
+    NT35310_CMD_READ_DISPLAY_ID        = 0x04,
 
     NT35310_CMD_ENTER_SLEEP_MODE       = 0x10,
     NT35310_CMD_EXIT_SLEEP_MODE        = 0x11,
@@ -40,6 +59,7 @@ typedef enum {
     NT35310_CMD_SET_HORIZONTAL_ADDRESS = 0x2A,
     NT35310_CMD_SET_VERTICAL_ADDRESS   = 0x2B,
     NT35310_CMD_WRITE_MEMORY_START     = 0x2C,
+    NT35310_CMD_READ_MEMORY_START      = 0x2E,
 
     NT35310_CMD_SET_ADDRESS_MODE       = 0x36,
 
@@ -49,21 +69,90 @@ typedef enum {
     NT35310_CMD_WRCTRLD                = 0x52, /* Write display CTRL */
 } nt35310_command_e;
 
+/**
+ * Power-up timing, from datasheet minimums.
+ */
+#define NT35310_RESET_PULSE_US    10     /*!< Minimum reset low pulse width */
+#define NT35310_RESET_RECOVERY_US 120000 /*!< Reset to first command. Only 5 ms from sleep-in mode, but after a warm reset of the K210 the panel may still be in sleep-out mode. */
+#define NT35310_SLEEP_OUT_US      5000   /*!< Exit sleep to next command */
+
+/**
+ * SET_ADDRESS_MODE bits
+ */
+#define NT35310_ADDR_MODE_MY  0x80 /*!< Row address order (bottom-to-top) */
+#define NT35310_ADDR_MODE_MX  0x40 /*!< Column address order (right-to-left) */
+#define NT35310_ADDR_MODE_MV  0x20 /*!< Row/column exchange */
+#define NT35310_ADDR_MODE_ML  0x10 /*!< Vertical refresh order */
+#define NT35310_ADDR_MODE_BGR 0x08 /*!< BGR color order */
+
+/**
+ * SPI clock rates, in Hz. NT35310_CLK_RATE_DEFAULT is known to work, faster
+ * rates can be verified with NT35310::autoClockRate.
+ */
+#define NT35310_CLK_RATE_DEFAULT 5000000
+#define NT35310_CLK_RATE_TIERS   { 40000000, 30000000, 20000000, 15000000, 10000000, NT35310_CLK_RATE_DEFAULT }
+
+#define NT35310_SELFTEST_SIZE    8 /*!< Width and height of area used for GRAM readback test */
+
+typedef struct {
+    uint32_t transfers; /*!< Number of SPI transfers */
+    uint64_t bytes;     /*!< Number of bytes sent */
+    uint64_t cycles;    /*!< CPU cycles spent waiting on transfers */
+} nt35310_stats_t;
+
+/**
+ * Callback used to test whether the display works at a given clock rate.
+ * 
+ * @param ctx  Context pointer
+ * @param rate Clock rate to test, in Hz
+ * 
+ * @return true if display works at this rate, else false
+ */
+typedef bool (*nt35310_clk_probe_t)(void *ctx, uint32_t rate);
+
+typedef enum {
+    NT35310_ROTATION_0   = 0, /* Native portrait orientation */
+    NT35310_ROTATION_90  = 1, /* Rotated 90 degrees clockwise, landscape */
+    NT35310_ROTATION_180 = 2, /* Upside-down portrait */
+    NT35310_ROTATION_270 = 3  /* Rotated 270 degrees clockwise, landscape */
+} nt35310_rotation_e;
+
+typedef enum {
+    NT35310_INIT_IDLE = 0,  /* Initialization not yet started */
+    NT35310_INIT_RESET,     /* Reset line asserted */
+    NT35310_INIT_RECOVERY,  /* Reset released, waiting for controller */
+    NT35310_INIT_SLEEP_OUT, /* Exit sleep sent, waiting for power-up */
+    NT35310_INIT_READY      /* Display on, accepting pixel data */
+} nt35310_init_state_e;
+
 class NT35310 {
 private:
     spi_device_num_t  spiDev; /*!< SPI device number the LCD is attached to. */
     spi_chip_select_t spiCS;  /*!< Chip Select line to use for SPI interface. */
 
-    uint16_t          width;  /*!< Width of LCD in pixels. */
-    uint16_t          height; /*!< Height of LCD in pixels. */
+    uint16_t          panelWidth;  /*!< Native width of LCD in pixels. */
+    uint16_t          panelHeight; /*!< Native height of LCD in pixels. */
+    uint16_t          width;       /*!< Width of LCD in pixels, in current orientation. */
+    uint16_t          height;      /*!< Height of LCD in pixels, in current orientation. */
+
+    nt35310_rotation_e rotation;   /*!< Current rotation */
+    bool               mirror;     /*!< Whether image is mirrored horizontally */
 
     uint8_t           RSTNum; /*!< GPIOHS number for Reset pin */
     uint8_t           DCNum;  /*!< GPIOHS number for Data Clock pin */
 
+    uint32_t             clkRate;      /*!< Requested SPI clock rate, in Hz */
+    nt35310_stats_t      stats;        /*!< Transfer statistics */
+
+    uint8_t              pixelBits;    /*!< SPI frame size set up for pixel data, 0 if SPI was used for anything else since */
+
+    nt35310_init_state_e initState;    /*!< Current state of power-up sequence */
+    uint64_t             initDeadline; /*!< Time, in us, at which the next power-up step may run */
+
     /**
-     * Perform hardware reset of display.
+     * Send configuration commands once the controller has left sleep mode.
      */
-    void reset(void);
+    void configure(void);
     
     /**
      * Sets area of display accessible through it's interface for subsequent
@@ -110,6 +199,49 @@ private:
      */
     void write32(const uint32_t *data, size_t len);
 
+    /**
+     * Record a completed transfer in the statistics.
+     * 
+     * @param bytes Number of bytes transferred
+     * @param start Cycle count at start of transfer
+     */
+    void account(size_t bytes, uint64_t start);
+
+    /**
+     * Send a command, then read back response data. Needs the LCD's RD line
+     * to be driven by the SPI clock.
+     * 
+     * @param cmd  Command to send
+     * @param data Buffer to store response in
+     * @param len  Number of bytes to read
+     */
+    void read(nt35310_command_e cmd, uint8_t *data, size_t len);
+
+    /**
+     * Probe callback for autoClockRate, writes a test pattern at the given rate
+     * and reads it back.
+     */
+    static bool selfTest(void *ctx, uint32_t rate);
+
+    /**
+     * Set up SPI for sending pixel data, if not already set up for the given
+     * frame size.
+     * 
+     * @param bits SPI frame size
+     */
+    void pixelFrames(uint8_t bits);
+
+    /**
+     * Write part of a pixel buffer to the display, straight from the buffer.
+     * In 16-bit mode, pairs are sent as 32-bit frames, and a pixel without
+     * a partner at either end of the run is sent as its own 16-bit frame.
+     * 
+     * @param buff  Pixel buffer, see NT35310_PIXEL_INDEX
+     * @param start Index of first pixel to write
+     * @param len   Number of pixels to write
+     */
+    void sendPixels(const nt35310_pixel_t *buff, size_t start, size_t len);
+
     /**
      * Write single value multiple times to display
      * 
@@ -130,10 +262,125 @@ public:
     NT35310(spi_device_num_t spiDev, spi_chip_select_t spiCS, uint8_t RSTNum, uint8_t DCNum, uint16_t width, uint16_t height);
 
     /**
-     * Initialize display.
+     * Initialize display, blocking until it is ready.
+     *
+     * @see initStart
      */
     void init(void);
 
+    /**
+     * Begin non-blocking initialization of the display. initPoll must be
+     * called until it returns true before any other operations are performed.
+     */
+    void initStart(void);
+
+    /**
+     * Advance the power-up sequence if the current step's delay has elapsed.
+     *
+     * @return true if display is ready to accept pixel data, else false
+     */
+    bool initPoll(void);
+
+
+    /**
+     * Set SPI clock rate. May be called before or after init.
+     * 
+     * @param rate Clock rate, in Hz
+     * 
+     * @return Actual clock rate, in Hz
+     */
+    uint32_t setClockRate(uint32_t rate);
+
+    /**
+     * Check whether anything can be read back from the display, i.e. the
+     * display ID reads as something other than a floating bus.
+     * 
+     * @return true if readback works, else false
+     */
+    bool readbackAvailable(void);
+
+    /**
+     * Find the fastest clock rate at which display ID and GRAM contents read
+     * back correctly, and switch to it. If readback does not work at all,
+     * NT35310_CLK_RATE_DEFAULT is used, check readbackAvailable first to pick
+     * a different rate instead. Must be called after init, overwrites a small
+     * area at the top-left of the display.
+     * 
+     * @return Selected clock rate, in Hz
+     */
+    uint32_t autoClockRate(void);
+
+    /**
+     * Pick the fastest clock rate that passes a probe. Tiers are tried from
+     * first to last, and should be ordered fastest first.
+     * 
+     * @param tiers    Clock rates to try, in Hz
+     * @param count    Number of clock rates
+     * @param fallback Rate to return if no tier passes
+     * @param probe    Function testing whether a rate works
+     * @param ctx      Context passed to probe
+     * 
+     * @return Selected clock rate, in Hz
+     */
+    static uint32_t selectClockRate(const uint32_t *tiers, size_t count, uint32_t fallback,
+                                    nt35310_clk_probe_t probe, void *ctx);
+
+    /**
+     * Read the display ID.
+     * 
+     * @return 24-bit display ID
+     */
+    uint32_t readID(void);
+
+    /**
+     * Get transfer statistics.
+     * 
+     * @param out Where to store statistics
+     */
+    void getStats(nt35310_stats_t *out);
+
+    /**
+     * Clear transfer statistics.
+     */
+    void resetStats(void);
+
+    /**
+     * Get average throughput since statistics were last cleared.
+     * 
+     * @return Throughput, in bytes per second
+     */
+    uint32_t getThroughput(void);
+
+    /**
+     * Compute SET_ADDRESS_MODE value for the given orientation.
+     * 
+     * @param rotation Display rotation
+     * @param mirror   Mirror image horizontally, applied after rotation
+     * 
+     * @return Value for SET_ADDRESS_MODE command
+     */
+    static uint8_t addressMode(nt35310_rotation_e rotation, bool mirror);
+
+    /**
+     * Set display orientation. This is done by the display controller, so
+     * coordinates passed to all drawing functions are in the new orientation
+     * with no extra cost. May be called before or after init. Existing display
+     * contents are not redrawn.
+     * 
+     * @param rotation Display rotation
+     * @param mirror   Mirror image horizontally, applied after rotation
+     */
+    void setOrientation(nt35310_rotation_e rotation, bool mirror);
+
+    /**
+     * @return Width of display in current orientation
+     */
+    uint16_t getWidth(void);
+
+    /**
+     * @return Height of display in current orientation
+     */
+    uint16_t getHeight(void);
 
     /**
      * Fill the part of the display with the specified color.
@@ -156,25 +403,51 @@ public:
     void fill(uint32_t color);
 
     /**
-     * Convert 24-bit raw RGB data to a format ready to be directly written
-     * to the LCD.
+     * Convert packed 8-bit RGB data into a pixel buffer.
      * 
-     * @param dest Destination buffer
-     * @param src  Source buffer
-     * @param len  Number of pixels in image data
+     * @param dest Pixel buffer, see NT35310_PIXEL_INDEX
+     * @param src  RGB data, 3 bytes per pixel
+     * @param len  Number of pixels
      */
     static void RGB2Buffer(void *dest, const void *src, size_t len);
 
     /**
      * Write rectangular bugger to the display at the specified location.
      * 
-     * @param buff   Buffer with pixel data, in display format
+     * The buffer is sent as-is, so it must already be in display format: in
+     * 16-bit mode pixels are swapped within each pair (NT35310_PIXEL_INDEX),
+     * the buffer must be aligned to NT35310_BUFFER_ALIGN, and it must hold a
+     * whole number of pixel pairs. Plain RGB565 images come out with every
+     * pair swapped, and must first be converted, e.g. with RGB2Buffer.
+     * 
+     * @param buff   Pixel buffer, in display format
      * @param width  Width of the buffer
      * @param height Height of the buffer
      * @param x      X-coordinate at which to display buffer
      * @param y      Y-coordinate at which to display buffer
+     * 
+     * @see blit
      */
     void writeBuffer(const void *buff, uint16_t width, uint16_t height, uint16_t x, uint16_t y);
+
+    /**
+     * Write a rectangle cut from a larger image (e.g. a sprite sheet) to the
+     * display. Rows are sent by DMA directly from the source, and runs of
+     * full-width rows are sent as a single transfer. In 16-bit mode, a row
+     * starting or ending halfway through a pixel pair costs an extra
+     * single-pixel transfer.
+     * 
+     * @param src    Source image, in display format as for writeBuffer
+     * @param stride Width of source image, in pixels
+     * @param sx     X-coordinate of rectangle within source
+     * @param sy     Y-coordinate of rectangle within source
+     * @param width  Width of rectangle
+     * @param height Height of rectangle
+     * @param x      X-coordinate at which to display rectangle
+     * @param y      Y-coordinate at which to display rectangle
+     */
+    void blit(const nt35310_pixel_t *src, uint16_t stride, uint16_t sx, uint16_t sy,
+              uint16_t width, uint16_t height, uint16_t x, uint16_t y);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,153 @@
+#ifndef SEVENSEGMENT_HPP
+#define SEVENSEGMENT_HPP
+
+#include <stdint.h>
+
+/**
+ * Seven segment number rendering, in the style of the 8050A's own display.
+ * Segments are drawn with fillRect, so no font data is needed and any
+ * framebuffer providing fillRect(x1, y1, x2, y2, idx) can be drawn to.
+ *
+ * Segment layout:
+ *    aaa
+ *   f   b
+ *    ggg
+ *   e   c
+ *    ddd
+ */
+
+#define SEVENSEG_SEG_A (1U << 0)
+#define SEVENSEG_SEG_B (1U << 1)
+#define SEVENSEG_SEG_C (1U << 2)
+#define SEVENSEG_SEG_D (1U << 3)
+#define SEVENSEG_SEG_E (1U << 4)
+#define SEVENSEG_SEG_F (1U << 5)
+#define SEVENSEG_SEG_G (1U << 6)
+
+#define SEVENSEG_BLANK 0
+#define SEVENSEG_MINUS SEVENSEG_SEG_G
+
+/* Letters, for labelling readings */
+#define SEVENSEG_LETTER_B (SEVENSEG_SEG_C | SEVENSEG_SEG_D | SEVENSEG_SEG_E | SEVENSEG_SEG_F | SEVENSEG_SEG_G) /*!< Lower case b */
+#define SEVENSEG_LETTER_D (SEVENSEG_SEG_B | SEVENSEG_SEG_C | SEVENSEG_SEG_D | SEVENSEG_SEG_E | SEVENSEG_SEG_G) /*!< Lower case d */
+#define SEVENSEG_LETTER_P (SEVENSEG_SEG_A | SEVENSEG_SEG_B | SEVENSEG_SEG_E | SEVENSEG_SEG_F | SEVENSEG_SEG_G)
+#define SEVENSEG_LETTER_U (SEVENSEG_SEG_B | SEVENSEG_SEG_C | SEVENSEG_SEG_D | SEVENSEG_SEG_E | SEVENSEG_SEG_F)
+
+#define SEVENSEG_DIGITS    5     /*!< Digits drawn by sevenseg_reading, enough for the 8050A's 19999 counts */
+#define SEVENSEG_MAX_COUNT 99999 /*!< Largest magnitude sevenseg_reading can show */
+
+static const uint8_t sevenseg_digits[10] = {
+    SEVENSEG_SEG_A | SEVENSEG_SEG_B | SEVENSEG_SEG_C | SEVENSEG_SEG_D | SEVENSEG_SEG_E | SEVENSEG_SEG_F,
+    SEVENSEG_SEG_B | SEVENSEG_SEG_C,
+    SEVENSEG_SEG_A | SEVENSEG_SEG_B | SEVENSEG_SEG_D | SEVENSEG_SEG_E | SEVENSEG_SEG_G,
+    SEVENSEG_SEG_A | SEVENSEG_SEG_B | SEVENSEG_SEG_C | SEVENSEG_SEG_D | SEVENSEG_SEG_G,
+    SEVENSEG_SEG_B | SEVENSEG_SEG_C | SEVENSEG_SEG_F | SEVENSEG_SEG_G,
+    SEVENSEG_SEG_A | SEVENSEG_SEG_C | SEVENSEG_SEG_D | SEVENSEG_SEG_F | SEVENSEG_SEG_G,
+    SEVENSEG_SEG_A | SEVENSEG_SEG_C | SEVENSEG_SEG_D | SEVENSEG_SEG_E | SEVENSEG_SEG_F | SEVENSEG_SEG_G,
+    SEVENSEG_SEG_A | SEVENSEG_SEG_B | SEVENSEG_SEG_C,
+    SEVENSEG_SEG_A | SEVENSEG_SEG_B | SEVENSEG_SEG_C | SEVENSEG_SEG_D | SEVENSEG_SEG_E | SEVENSEG_SEG_F | SEVENSEG_SEG_G,
+    SEVENSEG_SEG_A | SEVENSEG_SEG_B | SEVENSEG_SEG_C | SEVENSEG_SEG_D | SEVENSEG_SEG_F | SEVENSEG_SEG_G
+};
+
+typedef struct {
+    uint16_t width;     /*!< Digit width, in pixels */
+    uint16_t height;    /*!< Digit height, in pixels */
+    uint16_t thickness; /*!< Segment thickness, in pixels */
+    uint16_t spacing;   /*!< Gap between digits, in pixels. Must be at least thickness to fit decimal points. */
+    uint8_t  on;        /*!< Palette index of lit segments */
+    uint8_t  off;       /*!< Palette index of unlit segments */
+} sevenseg_style_t;
+
+/**
+ * @return Width of a reading drawn by sevenseg_reading, in pixels
+ */
+static inline uint16_t sevenseg_reading_width(const sevenseg_style_t *style) {
+    /* Sign, then digits */
+    return (uint16_t)(((SEVENSEG_DIGITS + 1) * (style->width + style->spacing)) - style->spacing);
+}
+
+/**
+ * Draw a single character cell. Every segment is drawn, either lit or unlit,
+ * so the previous contents are fully replaced.
+ *
+ * @param fb    Framebuffer to draw to
+ * @param x     Left edge of cell
+ * @param y     Top edge of cell
+ * @param style Dimensions and colors
+ * @param segs  Lit segments, see SEVENSEG_SEG_*
+ */
+template<typename FB>
+void sevenseg_cell(FB &fb, uint16_t x, uint16_t y, const sevenseg_style_t *style, uint8_t segs) {
+    uint16_t w       = style->width;
+    uint16_t h       = style->height;
+    uint16_t t       = style->thickness;
+    uint16_t gTop    = y + (h / 2) - (t / 2); /* First row of segment g */
+    uint16_t gBottom = gTop + t - 1;          /* Last row of segment g */
+
+#define SEVENSEG_FILL(seg, x1, y1, x2, y2) \
+    fb.fillRect((x1), (y1), (x2), (y2), (segs & (seg)) ? style->on : style->off)
+
+    SEVENSEG_FILL(SEVENSEG_SEG_A, x + t,     y,           x + w - t - 1, y + t - 1);
+    SEVENSEG_FILL(SEVENSEG_SEG_B, x + w - t, y + t,       x + w - 1,     gTop - 1);
+    SEVENSEG_FILL(SEVENSEG_SEG_C, x + w - t, gBottom + 1, x + w - 1,     y + h - t - 1);
+    SEVENSEG_FILL(SEVENSEG_SEG_D, x + t,     y + h - t,   x + w - t - 1, y + h - 1);
+    SEVENSEG_FILL(SEVENSEG_SEG_E, x,         gBottom + 1, x + t - 1,     y + h - t - 1);
+    SEVENSEG_FILL(SEVENSEG_SEG_F, x,         y + t,       x + t - 1,     gTop - 1);
+    SEVENSEG_FILL(SEVENSEG_SEG_G, x + t,     gTop,        x + w - t - 1, gBottom);
+
+#undef SEVENSEG_FILL
+}
+
+/**
+ * Draw a reading as a sign followed by SEVENSEG_DIGITS digits, with leading
+ * zeros blanked up to the ones digit. Readings too large to show are drawn as
+ * dashes.
+ *
+ * @param fb       Framebuffer to draw to
+ * @param x        Left edge of reading
+ * @param y        Top edge of reading
+ * @param style    Dimensions and colors
+ * @param counts   Reading, ignoring the decimal point
+ * @param decimals Number of digits after the decimal point, 0 for none
+ */
+template<typename FB>
+void sevenseg_reading(FB &fb, uint16_t x, uint16_t y, const sevenseg_style_t *style,
+                      int32_t counts, uint8_t decimals) {
+    uint16_t pitch = style->width + style->spacing;
+    uint16_t t     = style->thickness;
+    uint32_t mag   = (counts < 0) ? (uint32_t)-counts : (uint32_t)counts;
+    bool     over  = (mag > SEVENSEG_MAX_COUNT);
+
+    if(decimals >= SEVENSEG_DIGITS) {
+        decimals = 0;
+    }
+
+    sevenseg_cell(fb, x, y, style, (counts < 0) ? SEVENSEG_MINUS : SEVENSEG_BLANK);
+
+    uint8_t segs[SEVENSEG_DIGITS];
+    for(int i = SEVENSEG_DIGITS - 1; i >= 0; i--) {
+        /* Keep every digit from the ones digit rightwards, even if zero */
+        bool lead = (mag == 0) && (i < (SEVENSEG_DIGITS - 1 - decimals));
+        if(over) {
+            segs[i] = SEVENSEG_MINUS;
+        } else {
+            segs[i] = lead ? SEVENSEG_BLANK : sevenseg_digits[mag % 10];
+        }
+        mag /= 10;
+    }
+
+    for(uint8_t i = 0; i < SEVENSEG_DIGITS; i++) {
+        uint16_t cx = x + ((i + 1) * pitch);
+        sevenseg_cell(fb, cx, y, style, segs[i]);
+
+        if(i < (SEVENSEG_DIGITS - 1)) {
+            /* Decimal point, centered in the gap after this digit */
+            uint16_t dx  = cx + style->width + ((style->spacing - t) / 2);
+            bool     lit = !over && decimals && (i == (SEVENSEG_DIGITS - 1 - decimals));
+            fb.fillRect(dx, y + style->height - t, dx + t - 1, y + style->height - 1,
+                        lit ? style->on : style->off);
+        }
+    }
+}
+
+#endif
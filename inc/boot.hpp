@@ -0,0 +1,46 @@
+#ifndef BOOT_HPP
+#define BOOT_HPP
+
+#include <stdint.h>
+
+typedef enum {
+    BOOT_EVENT_START = 0,     /* PLL configured, timeline valid from here */
+    BOOT_EVENT_DECODER_READY, /* 8050A interrupts registered */
+    BOOT_EVENT_CORE1_START,   /* Core 1 entered */
+    BOOT_EVENT_LCD_RESET,     /* LCD reset released */
+    BOOT_EVENT_LCD_READY,     /* LCD accepting pixel data */
+    BOOT_EVENT_SPLASH,        /* Splash screen written */
+    BOOT_EVENT_FIRST_READING, /* First 8050A reading drawn to the display */
+    BOOT_EVENT_MAX
+} boot_event_e;
+
+/**
+ * Get current time since reset.
+ *
+ * @return Time in microseconds
+ */
+uint64_t boot_time_us(void);
+
+/**
+ * Record the time at which a boot event occured. Only the first occurance of
+ * each event is recorded.
+ *
+ * @param event Event to record
+ */
+void boot_mark(boot_event_e event);
+
+/**
+ * Get the recorded time of a boot event.
+ *
+ * @param event Event to look up
+ *
+ * @return Time in microseconds since reset, 0 if event has not occured
+ */
+uint64_t boot_get(boot_event_e event);
+
+/**
+ * Print the boot timeline to the serial port.
+ */
+void boot_report(void);
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef FIXLOG_HPP
+#define FIXLOG_HPP
+
+#include <stdint.h>
+
+/**
+ * Fixed-point logarithm/exponent math, using lookup tables generated at
+ * compile time. Values are in Q16.16.
+ */
+
+#define FIXLOG_FRAC_BITS   16
+#define FIXLOG_ONE         (1 << FIXLOG_FRAC_BITS)
+#define FIXLOG_TABLE_BITS  8                 /*!< log2 of number of table intervals */
+#define FIXLOG_TABLE_SIZE  ((1 << FIXLOG_TABLE_BITS) + 1)
+
+#define FIXLOG_INVALID     INT32_MIN         /*!< Returned by fixlog_log2 for non-positive input */
+
+#define FIXLOG_LOG10_2     19728             /*!< log10(2), Q16.16 */
+#define FIXLOG_LOG2_10     217706            /*!< log2(10), Q16.16 */
+#define FIXLOG_DB_PER_LOG2 394566            /*!< 20 * log10(2), Q16.16 */
+#define FIXLOG_LOG2_PER_DB 10885             /*!< log2(10) / 20, Q16.16 */
+
+/**
+ * Multiply two Q16.16 values.
+ */
+static inline int32_t fixlog_mul(int32_t a, int32_t b) {
+    return (int32_t)(((int64_t)a * b) >> FIXLOG_FRAC_BITS);
+}
+
+/**
+ * Convert a Q16.16 value to float.
+ */
+static inline float fixlog_to_float(int32_t a) {
+    return (float)a * (1.0f / FIXLOG_ONE);
+}
+
+/**
+ * Base-2 logarithm.
+ *
+ * @param x Value to take logarithm of
+ *
+ * @return log2(x) in Q16.16, FIXLOG_INVALID if x <= 0
+ */
+int32_t fixlog_log2(float x);
+
+/**
+ * Base-2 exponent.
+ *
+ * @param x Exponent, in Q16.16
+ *
+ * @return 2^x
+ */
+float fixlog_exp2(int32_t x);
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef LOG_HPP
+#define LOG_HPP
+
+#include <stdint.h>
+#include <string.h>
+
+#include <bsp.h>
+
+/**
+ * Log output format
+ *  0: Entries are formatted to text by log_flush
+ *  1: Entries are emitted as raw binary frames, to be decoded on the host by
+ *     tools/logdecode.py
+ */
+#define LOG_BINARY 0
+
+#define LOG_QUEUE_SIZE 64 /*!< Entries per core, must be a power of two */
+#define LOG_MAX_ARGS   6  /*!< Maximum number of arguments per entry */
+#define LOG_CORES      2  /*!< Number of cores that may log */
+
+#define LOG_FRAME_SYNC0 0xA5 /*!< First byte of binary frame */
+#define LOG_FRAME_SYNC1 0x5A /*!< Second byte of binary frame */
+
+/**
+ * Log message formats. Arguments are stored as 32-bit values, so length
+ * modifiers in conversions are ignored. Floating point conversions are stored
+ * as single-precision floats. Strings are not supported.
+ *
+ * This list is also parsed by tools/logdecode.py, entries must stay on one
+ * line each.
+ */
+#define LOG_FORMATS(X) \
+    X(LOG_FMT_HELLO,            "Core %lu Hello world") \
+    X(LOG_FMT_FLUKE_DEBUG,      "Fluke8050A::debug [%hhu,%hhu,%hhu,%hhu,%02hhX]: %+5.02f") \
+    X(LOG_FMT_FLUKE_REL,        "                           Rel: %+5.02f") \
+    X(LOG_FMT_FLUKE_DERIVED,    "Derived: %+.3f (%+.2f%%), %+.2f dB, level %+.3f") \
+    X(LOG_FMT_READING_FILTERED, "Filtered: %+.3f, settled: %u") \
+    X(LOG_FMT_LCD_CLOCK,        "LCD SPI clock: %lu Hz") \
+    X(LOG_FMT_LCD_CLOCK_FIXED,  "LCD readback unavailable, SPI clock fixed at %lu Hz") \
+    X(LOG_FMT_LCD_STATS,        "LCD: %lu transfers, %lu bytes/s")
+
+#define LOG_FMT_ENUM(id, fmt) id,
+typedef enum {
+    LOG_FORMATS(LOG_FMT_ENUM)
+    LOG_FMT_MAX
+} log_fmt_e;
+#undef LOG_FMT_ENUM
+
+typedef struct {
+    uint16_t fmt;                /*!< Format ID, see log_fmt_e */
+    uint8_t  nargs;              /*!< Number of valid arguments */
+    uint8_t  core;               /*!< Core the entry was logged from */
+    uint32_t time;               /*!< Low 32 bits of cycle counter at time of logging */
+    uint32_t args[LOG_MAX_ARGS]; /*!< Raw arguments */
+} log_entry_t;
+
+typedef struct {
+    volatile uint32_t head;    /*!< Next entry to write, only modified by producing core */
+    volatile uint32_t tail;    /*!< Next entry to read, only modified by log_flush */
+    volatile uint32_t dropped; /*!< Number of entries dropped due to a full queue */
+    log_entry_t       entries[LOG_QUEUE_SIZE];
+} log_queue_t;
+
+extern log_queue_t log_queues[LOG_CORES];
+
+static inline uint32_t log_arg(float val) {
+    uint32_t raw;
+    memcpy(&raw, &val, sizeof(raw));
+    return raw;
+}
+
+static inline uint32_t log_arg(double val) {
+    return log_arg((float)val);
+}
+
+template<typename T>
+static inline uint32_t log_arg(T val) {
+    return (uint32_t)val;
+}
+
+/**
+ * Queue a log message. Safe to call from interrupt context. Formatting is
+ * deferred until log_flush is called.
+ *
+ * @param fmt  Message format
+ * @param args Message arguments, must match the conversions in the format
+ */
+template<typename... Args>
+static inline void log_msg(log_fmt_e fmt, Args... args) {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "Too many log arguments");
+    const uint32_t argv[sizeof...(Args) + 1] = { log_arg(args)... };
+
+    uint64_t     core = current_coreid();
+    log_queue_t *q    = &log_queues[core];
+
+    /* Queue is per-core, so only need to guard against our own interrupts. */
+    uint64_t mie  = clear_csr(mstatus, MSTATUS_MIE);
+    uint32_t head = q->head;
+
+    if((head - __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE)) >= LOG_QUEUE_SIZE) {
+        q->dropped++;
+    } else {
+        log_entry_t *ent = &q->entries[head & (LOG_QUEUE_SIZE - 1)];
+        ent->fmt   = (uint16_t)fmt;
+        ent->nargs = sizeof...(Args);
+        ent->core  = (uint8_t)core;
+        ent->time  = (uint32_t)read_cycle();
+        for(size_t i = 0; i < sizeof...(Args); i++) {
+            ent->args[i] = argv[i];
+        }
+        __atomic_store_n(&q->head, head + 1, __ATOMIC_RELEASE);
+    }
+
+    set_csr(mstatus, mie & MSTATUS_MIE);
+}
+
+/**
+ * Output all queued log messages from every core. Should only be called from
+ * a single core.
+ */
+void log_flush(void);
+
+#endif
@@ -2,6 +2,7 @@
 #define PINS_H
 
 #include <spi.h>
+#include <uart.h>
 
 /* RGB LED */
 #define LED_PIN_R 13
@@ -26,6 +27,21 @@
 
 #define LCD_WIDTH  240
 #define LCD_HEIGHT 320
+/* Orientation, see nt35310_rotation_e */
+#define LCD_ROTATION NT35310_ROTATION_0
+#define LCD_MIRROR   false
+/* SPI clock rate in Hz, one of NT35310_CLK_RATE_TIERS. Used unless the
+ * self-test below selects a rate. */
+#define LCD_CLK_RATE 15000000
+/* Run SPI clock self-test at startup. Needs the LCD's RD line, which is not
+ * routed on this board, so LCD_CLK_RATE is used if readback fails. */
+#define LCD_CLK_AUTO 0
+
+/* Display mirror UART */
+#define MIRROR_PIN_TX   9
+#define MIRROR_PIN_RX   10
+#define MIRROR_UART_DEV UART_DEVICE_1
+#define MIRROR_BAUD     921600
 
 /* 8050A pins */
 #define FLUKE8050_PIN_DP  1
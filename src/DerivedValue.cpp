@@ -0,0 +1,87 @@
+#include <cmath>
+
+#include <fixlog.hpp>
+#include <DerivedValue.hpp>
+
+DerivedValue::DerivedValue(void) {
+    this->values.delta   = NAN;
+    this->values.percent = NAN;
+    this->values.dbRel   = NAN;
+    this->values.level   = NAN;
+    this->seq            = 0;
+
+    this->relative   = NAN;
+    this->relInverse = NAN;
+    this->relLog2    = FIXLOG_INVALID;
+
+    this->setImpedance(DERIVEDVALUE_DEFAULT_IMPEDANCE);
+}
+
+void DerivedValue::setImpedance(float ohms) {
+    /* Reference voltage for 0 dBm is sqrt(1 mW * Z) */
+    int32_t l = fixlog_log2(0.001f * ohms);
+    this->refLog2 = (l == FIXLOG_INVALID) ? FIXLOG_INVALID : (l / 2);
+}
+
+void DerivedValue::update(float value, float relative, bool dB) {
+    derived_value_t v;
+    bool    rel      = !std::isnan(relative);
+    /* In relative mode the displayed value already has relative subtracted */
+    float   absolute = rel ? (value + relative) : value;
+    int32_t absLog2  = dB ? FIXLOG_INVALID : fixlog_log2(fabsf(absolute));
+
+    if(!rel) {
+        v.delta   = NAN;
+        v.percent = NAN;
+        v.dbRel   = NAN;
+    } else {
+        if(relative != this->relative) {
+            /* Only happens when relative mode is entered, so the divide is
+             * not paid per reading. */
+            this->relative   = relative;
+            this->relInverse = (relative != 0.0f) ? (100.0f / relative) : NAN;
+            this->relLog2    = fixlog_log2(fabsf(relative));
+        }
+
+        v.delta   = value;
+        v.percent = value * this->relInverse;
+
+        if(dB) {
+            /* Already logarithmic, and already relative */
+            v.dbRel = value;
+        } else if((absLog2 == FIXLOG_INVALID) || (this->relLog2 == FIXLOG_INVALID)) {
+            v.dbRel = NAN;
+        } else {
+            /* 20 * log10(|absolute| / |relative|) */
+            v.dbRel = fixlog_to_float(fixlog_mul(absLog2 - this->relLog2, FIXLOG_DB_PER_LOG2));
+        }
+    }
+
+    if(this->refLog2 == FIXLOG_INVALID) {
+        v.level = NAN;
+    } else if(dB) {
+        /* V = Vref * 10^(dBm / 20) */
+        int32_t q = (int32_t)(absolute * FIXLOG_ONE);
+        v.level = fixlog_exp2(this->refLog2 + fixlog_mul(q, FIXLOG_LOG2_PER_DB));
+    } else if(absLog2 == FIXLOG_INVALID) {
+        v.level = NAN;
+    } else {
+        /* dBm = 20 * log10(V / Vref) */
+        v.level = fixlog_to_float(fixlog_mul(absLog2 - this->refLog2, FIXLOG_DB_PER_LOG2));
+    }
+
+    uint32_t seq = this->seq;
+    __atomic_store_n(&this->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    this->values = v;
+    __atomic_store_n(&this->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+void DerivedValue::get(derived_value_t *out) {
+    uint32_t seq;
+    do {
+        seq  = __atomic_load_n(&this->seq, __ATOMIC_ACQUIRE);
+        *out = this->values;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while((seq & 1) || (seq != __atomic_load_n(&this->seq, __ATOMIC_RELAXED)));
+}
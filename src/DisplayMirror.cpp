@@ -0,0 +1,219 @@
+#include <string.h>
+
+#include <DisplayMirror.hpp>
+
+DisplayMirror::DisplayMirror(uart_device_number_t uartDev, uint32_t baud, uint8_t bpp,
+                             uint16_t width, uint16_t height, uint8_t *shadow) {
+    this->uartDev = uartDev;
+    this->baud    = baud;
+
+    this->bpp      = bpp;
+    this->width    = width;
+    this->height   = height;
+    this->rowBytes = ((width * bpp) + 7) / 8;
+
+    this->shadow    = shadow;
+    this->paused     = false;
+    this->endPending = false;
+    this->bytesSent  = 0;
+
+    this->resync();
+}
+
+void DisplayMirror::init(void) {
+    uart_init(this->uartDev);
+    uart_configure(this->uartDev, this->baud, UART_BITWIDTH_8BIT, UART_STOP_1, UART_PARITY_NONE);
+}
+
+uint32_t DisplayMirror::getBytesSent(void) {
+    return this->bytesSent;
+}
+
+void DisplayMirror::resync(void) {
+    /* Host clears its copy to index 0 on INFO, so the shadow must match */
+    memset(this->shadow, 0, (size_t)this->rowBytes * this->height);
+    /* Force the palette to be sent */
+    memset(this->shadowPalette, 0xFF, sizeof(this->shadowPalette));
+    this->needInfo = true;
+    this->nextTile = 0;
+}
+
+void DisplayMirror::poll(void) {
+    char c;
+    while(uart_receive_data(this->uartDev, &c, 1) == 1) {
+        switch(c) {
+            case DISPLAYMIRROR_XOFF:
+                this->paused = true;
+                break;
+            case DISPLAYMIRROR_XON:
+                this->paused = false;
+                break;
+            case DISPLAYMIRROR_KEY:
+                this->resync();
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void DisplayMirror::sendFrame(displaymirror_frame_e type, const uint8_t *payload, uint16_t len) {
+    uint8_t head[5] = {
+        DISPLAYMIRROR_SYNC0, DISPLAYMIRROR_SYNC1,
+        (uint8_t)type, (uint8_t)len, (uint8_t)(len >> 8)
+    };
+    uint8_t sum = head[2] ^ head[3] ^ head[4];
+    for(uint16_t i = 0; i < len; i++) {
+        sum ^= payload[i];
+    }
+
+    uart_send_data(this->uartDev, (const char *)head, sizeof(head));
+    uart_send_data(this->uartDev, (const char *)payload, len);
+    uart_send_data(this->uartDev, (const char *)&sum, 1);
+
+    this->bytesSent += sizeof(head) + len + 1;
+}
+
+size_t DisplayMirror::packBits(uint8_t *dest, const uint8_t *src, size_t len) {
+    size_t out = 0;
+    size_t i   = 0;
+
+    while(i < len) {
+        /* Length of run starting here */
+        size_t run = 1;
+        while(((i + run) < len) && (run < 128) && (src[i + run] == src[i])) {
+            run++;
+        }
+
+        if(run >= 2) {
+            dest[out++] = (uint8_t)(257 - run);
+            dest[out++] = src[i];
+            i += run;
+            continue;
+        }
+
+        /* Literal, ends where a run of at least 2 starts */
+        size_t lit = 1;
+        while(((i + lit) < len) && (lit < 128) &&
+              !(((i + lit + 1) < len) && (src[i + lit] == src[i + lit + 1]))) {
+            lit++;
+        }
+        dest[out++] = (uint8_t)(lit - 1);
+        memcpy(&dest[out], &src[i], lit);
+        out += lit;
+        i   += lit;
+    }
+
+    return out;
+}
+
+void DisplayMirror::update(const uint8_t *pixels, const nt35310_pixel_t *palette, size_t maxBytes) {
+    uint32_t start = this->bytesSent;
+
+    this->poll();
+    if(this->paused) {
+        return;
+    }
+
+    if(this->needInfo) {
+        uint8_t info[7] = {
+            (uint8_t)this->width,  (uint8_t)(this->width >> 8),
+            (uint8_t)this->height, (uint8_t)(this->height >> 8),
+            this->bpp, DISPLAYMIRROR_TILE, NT35310_18BIT_COLOR
+        };
+        this->sendFrame(DISPLAYMIRROR_FRAME_INFO, info, sizeof(info));
+        this->needInfo   = false;
+        this->endPending = true;
+    }
+
+    uint16_t colors     = (uint16_t)(1U << this->bpp);
+    bool     palChanged = false;
+    for(uint16_t i = 0; i < colors; i++) {
+        if(this->shadowPalette[i] != (uint32_t)palette[i]) {
+            this->shadowPalette[i] = palette[i];
+            palChanged = true;
+        }
+    }
+    if(palChanged) {
+        this->frame[0] = (uint8_t)colors;
+        this->frame[1] = (uint8_t)(colors >> 8);
+        for(uint16_t i = 0; i < colors; i++) {
+            uint32_t c = this->shadowPalette[i];
+            this->frame[2 + (i * 4) + 0] = (uint8_t)c;
+            this->frame[2 + (i * 4) + 1] = (uint8_t)(c >> 8);
+            this->frame[2 + (i * 4) + 2] = (uint8_t)(c >> 16);
+            this->frame[2 + (i * 4) + 3] = (uint8_t)(c >> 24);
+        }
+        this->sendFrame(DISPLAYMIRROR_FRAME_PALETTE, this->frame, 2 + (colors * 4));
+        this->endPending = true;
+    }
+
+    uint16_t tileBytes = (DISPLAYMIRROR_TILE * this->bpp) / 8; /* Bytes per tile row */
+    uint16_t tilesX    = (this->rowBytes + tileBytes - 1) / tileBytes;
+    uint16_t tilesY    = (this->height + DISPLAYMIRROR_TILE - 1) / DISPLAYMIRROR_TILE;
+    uint8_t  delta[DISPLAYMIRROR_TILE * DISPLAYMIRROR_TILE];
+
+    uint32_t tiles     = (uint32_t)tilesX * tilesY;
+
+    /* Scan resumes after the last tile sent, so tiles that keep changing
+     * can't starve the rest of the screen when the budget runs out. */
+    for(uint32_t n = 0; n < tiles; n++) {
+        uint32_t tile = (this->nextTile + n) % tiles;
+        uint16_t tx   = (uint16_t)(tile % tilesX);
+        uint16_t ty   = (uint16_t)(tile / tilesX);
+
+        uint16_t y0   = ty * DISPLAYMIRROR_TILE;
+        uint16_t rows = ((this->height - y0) < DISPLAYMIRROR_TILE) ? (this->height - y0) : DISPLAYMIRROR_TILE;
+        uint16_t x0   = tx * tileBytes;
+        uint16_t cols = ((this->rowBytes - x0) < tileBytes) ? (this->rowBytes - x0) : tileBytes;
+
+        size_t   len  = 0;
+        bool     diff = false;
+        for(uint16_t r = 0; r < rows; r++) {
+            size_t         off = ((size_t)(y0 + r) * this->rowBytes) + x0;
+            const uint8_t *cur = &pixels[off];
+            const uint8_t *old = &this->shadow[off];
+            for(uint16_t c = 0; c < cols; c++) {
+                delta[len] = cur[c] ^ old[c];
+                diff      |= (delta[len] != 0);
+                len++;
+            }
+        }
+        if(!diff) {
+            continue;
+        }
+
+        this->frame[0] = (uint8_t)tx;
+        this->frame[1] = (uint8_t)(tx >> 8);
+        this->frame[2] = (uint8_t)ty;
+        this->frame[3] = (uint8_t)(ty >> 8);
+        size_t plen = DisplayMirror::packBits(&this->frame[4], delta, len);
+        this->sendFrame(DISPLAYMIRROR_FRAME_TILE, this->frame, (uint16_t)(4 + plen));
+        this->endPending = true;
+
+        for(uint16_t r = 0; r < rows; r++) {
+            size_t off = ((size_t)(y0 + r) * this->rowBytes) + x0;
+            memcpy(&this->shadow[off], &pixels[off], cols);
+        }
+
+        this->poll();
+        if(this->needInfo) {
+            /* Keyframe requested, the shadow no longer matches what the
+             * host has, so nothing more can be sent as a delta. Start over
+             * on the next update. */
+            return;
+        }
+        if(this->paused || ((this->bytesSent - start) >= maxBytes)) {
+            /* Remaining tiles are picked up on the next update */
+            this->nextTile = (tile + 1) % tiles;
+            return;
+        }
+    }
+
+    /* Full scan without running out of budget, so the host is up to date.
+     * Changes may have been sent by earlier updates that ran out of budget. */
+    if(this->endPending) {
+        this->sendFrame(DISPLAYMIRROR_FRAME_END, NULL, 0);
+        this->endPending = false;
+    }
+}
@@ -1,13 +1,18 @@
 #include <string.h>
-#include <stdio.h>
 #include <cmath>
 
 #include <gpiohs.h>
 
+#include <log.hpp>
 #include <Fluke8050A.hpp>
 
 Fluke8050A::Fluke8050A(fluke_8050a_pins_t *pins) {
     memcpy(&this->pins, pins, sizeof(fluke_8050a_pins_t));
+
+    this->samples = 0;
+    this->seq     = 0;
+    this->counts  = 0;
+    this->scale   = 1;
 }
 
 void Fluke8050A::init(void) {
@@ -40,6 +45,18 @@ float Fluke8050A::getValue(void) {
     return this->value;
 }
 
+int16_t Fluke8050A::getCounts(void) {
+    return this->counts;
+}
+
+float Fluke8050A::getScale(void) {
+    return this->scale;
+}
+
+uint8_t Fluke8050A::getStatus(void) {
+    return this->status;
+}
+
 float Fluke8050A::getRelative(void) {
     if(this->status & FLUKE8050A_STATUS_REL) {
         return this->relative;
@@ -48,14 +65,40 @@ float Fluke8050A::getRelative(void) {
     }
 }
 
+uint32_t Fluke8050A::getSampleCount(void) {
+    return this->samples;
+}
+
+uint32_t Fluke8050A::getReading(int16_t *counts, float *scale) {
+    uint32_t seq;
+    uint32_t samples;
+    do {
+        seq     = __atomic_load_n(&this->seq, __ATOMIC_ACQUIRE);
+        *counts = this->counts;
+        *scale  = this->scale;
+        samples = this->samples;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while((seq & 1) || (seq != __atomic_load_n(&this->seq, __ATOMIC_RELAXED)));
+
+    return samples;
+}
+
+void Fluke8050A::getDerived(derived_value_t *out) {
+    this->derived.get(out);
+}
+
+void Fluke8050A::setImpedance(float ohms) {
+    this->derived.setImpedance(ohms);
+}
+
 void Fluke8050A::debug(void) {
-    printf("Fluke8050A::debug [%hhu,%hhu,%hhu,%hhu,%02hhX]: %+5.02f\r\n",
-           this->bcd[3], this->bcd[2],
-           this->bcd[1], this->bcd[0],
-           this->status,
-           this->value);
+    log_msg(LOG_FMT_FLUKE_DEBUG,
+            this->bcd[3], this->bcd[2],
+            this->bcd[1], this->bcd[0],
+            this->status,
+            this->value);
     if(this->status & FLUKE8050A_STATUS_REL) {
-        printf("                           Rel: %+5.02f\r\n", this->relative);
+        log_msg(LOG_FMT_FLUKE_REL, this->relative);
     }
 }
 
@@ -85,7 +128,17 @@ int Fluke8050A::convert(void) {
         div *= 10;
     }
 
-    this->value = (float)val / div;
+    uint32_t seq = this->seq;
+    __atomic_store_n(&this->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    this->value  = (float)val / div;
+    this->counts = val;
+    this->scale  = div;
+    this->samples++;
+    __atomic_store_n(&this->seq, seq + 2, __ATOMIC_RELEASE);
+
+    this->derived.update(this->value, this->getRelative(),
+                         (this->status & FLUKE8050A_STATUS_DB));
 
     return 0;
 }
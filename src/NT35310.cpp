@@ -1,7 +1,13 @@
+#include <string.h>
+
 #include <gpiohs.h>
 #include <fpioa.h>
 #include <sleep.h>
+#include <sysctl.h>
+#include <encoding.h>
+#include <printf.h>
 
+#include <boot.hpp>
 #include <NT35310.hpp>
 
 NT35310::NT35310(spi_device_num_t spiDev, spi_chip_select_t spiCS, uint8_t RSTNum, uint8_t DCNum, uint16_t width, uint16_t height) {
@@ -11,28 +17,80 @@ NT35310::NT35310(spi_device_num_t spiDev, spi_chip_select_t spiCS, uint8_t RSTNu
     this->RSTNum = RSTNum;
     this->DCNum  = DCNum;
 
-    this->width  = width;
-    this->height = height;
+    this->panelWidth  = width;
+    this->panelHeight = height;
+    this->width       = width;
+    this->height      = height;
+
+    this->rotation = NT35310_ROTATION_0;
+    this->mirror   = false;
+
+    this->clkRate   = NT35310_CLK_RATE_DEFAULT;
+    this->pixelBits = 0;
+    this->resetStats();
+
+    this->initState    = NT35310_INIT_IDLE;
+    this->initDeadline = 0;
 }
 
 void NT35310::init(void) {
-    uint8_t data;
-    
+    this->initStart();
+    while(!this->initPoll());
+}
+
+void NT35310::initStart(void) {
     gpiohs_set_drive_mode(this->RSTNum, GPIO_DM_OUTPUT);
     gpiohs_set_drive_mode(this->DCNum,  GPIO_DM_OUTPUT);
     
     gpiohs_set_pin(this->DCNum,  GPIO_PV_HIGH);
     
     spi_init(this->spiDev, SPI_WORK_MODE_0, SPI_FF_OCTAL, 8, 0);
-    spi_set_clk_rate(this->spiDev, 5000000);
+    spi_set_clk_rate(this->spiDev, this->clkRate);
     
-    this->reset();
+    /* Hardware reset leaves the controller in the same state as a soft reset,
+     * so SOFT_RESET is not sent. */
+    gpiohs_set_pin(this->RSTNum, GPIO_PV_LOW);
+    this->initDeadline = boot_time_us() + NT35310_RESET_PULSE_US;
+    this->initState    = NT35310_INIT_RESET;
+}
+
+bool NT35310::initPoll(void) {
+    if((this->initState == NT35310_INIT_IDLE) ||
+       (this->initState == NT35310_INIT_READY)) {
+        return (this->initState == NT35310_INIT_READY);
+    }
 
-    this->command(NT35310_CMD_SOFT_RESET);
-    msleep(150);
-    this->command(NT35310_CMD_EXIT_SLEEP_MODE);
-    /* Need to wait 5+ ms before sending next command */
-    msleep(500);
+    uint64_t now = boot_time_us();
+    if(now < this->initDeadline) {
+        return false;
+    }
+
+    switch(this->initState) {
+        case NT35310_INIT_RESET:
+            gpiohs_set_pin(this->RSTNum, GPIO_PV_HIGH);
+            boot_mark(BOOT_EVENT_LCD_RESET);
+            this->initDeadline = now + NT35310_RESET_RECOVERY_US;
+            this->initState    = NT35310_INIT_RECOVERY;
+            break;
+        case NT35310_INIT_RECOVERY:
+            this->command(NT35310_CMD_EXIT_SLEEP_MODE);
+            this->initDeadline = now + NT35310_SLEEP_OUT_US;
+            this->initState    = NT35310_INIT_SLEEP_OUT;
+            break;
+        case NT35310_INIT_SLEEP_OUT:
+            this->configure();
+            boot_mark(BOOT_EVENT_LCD_READY);
+            this->initState    = NT35310_INIT_READY;
+            return true;
+        default:
+            break;
+    }
+
+    return false;
+}
+
+void NT35310::configure(void) {
+    uint8_t data;
 
     /* Pixel format: 16/18 bits-per-pixel */
 #if (NT35310_18BIT_COLOR)
@@ -43,8 +101,7 @@ void NT35310::init(void) {
     this->command(NT35310_CMD_SET_PIXEL_FORMAT);
     this->write8(&data, 1);
 
-    /* Address mode: Auto-increment Y, decrement X, top-down, left-right */
-    data = 0x40;
+    data = NT35310::addressMode(this->rotation, this->mirror);
     this->command(NT35310_CMD_SET_ADDRESS_MODE);
     this->write8(&data, 1);
     
@@ -53,13 +110,60 @@ void NT35310::init(void) {
     this->command(NT35310_CMD_SET_DISPLAY_ON);
 }
 
-void NT35310::reset(void) {
-    gpiohs_set_pin(this->RSTNum, GPIO_PV_LOW);
-    /* Documentation unclear, 1 ms min pulse? */
-    msleep(2);
-    gpiohs_set_pin(this->RSTNum, GPIO_PV_HIGH);
-    /* Reset duration 20 ms */
-    msleep(20);
+uint8_t NT35310::addressMode(nt35310_rotation_e rotation, bool mirror) {
+    uint8_t mode;
+
+    /* Native orientation: top-down, right-to-left column order */
+    switch(rotation) {
+        case NT35310_ROTATION_90:
+            mode = NT35310_ADDR_MODE_MV;
+            break;
+        case NT35310_ROTATION_180:
+            mode = NT35310_ADDR_MODE_MY;
+            break;
+        case NT35310_ROTATION_270:
+            mode = NT35310_ADDR_MODE_MV | NT35310_ADDR_MODE_MX | NT35310_ADDR_MODE_MY;
+            break;
+        case NT35310_ROTATION_0:
+        default:
+            mode = NT35310_ADDR_MODE_MX;
+            break;
+    }
+
+    if(mirror) {
+        /* With row/column exchange, the horizontal axis is the row order */
+        mode ^= (mode & NT35310_ADDR_MODE_MV) ? NT35310_ADDR_MODE_MY : NT35310_ADDR_MODE_MX;
+    }
+
+    return mode;
+}
+
+void NT35310::setOrientation(nt35310_rotation_e rotation, bool mirror) {
+    this->rotation = rotation;
+    this->mirror   = mirror;
+
+    if((rotation == NT35310_ROTATION_90) ||
+       (rotation == NT35310_ROTATION_270)) {
+        this->width  = this->panelHeight;
+        this->height = this->panelWidth;
+    } else {
+        this->width  = this->panelWidth;
+        this->height = this->panelHeight;
+    }
+
+    if(this->initState == NT35310_INIT_READY) {
+        uint8_t data = NT35310::addressMode(rotation, mirror);
+        this->command(NT35310_CMD_SET_ADDRESS_MODE);
+        this->write8(&data, 1);
+    }
+}
+
+uint16_t NT35310::getWidth(void) {
+    return this->width;
+}
+
+uint16_t NT35310::getHeight(void) {
+    return this->height;
 }
 
 void NT35310::setArea(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
@@ -99,24 +203,39 @@ void NT35310::fill(uint32_t color) {
 void NT35310::RGB2Buffer(void *dest, const void *src, size_t len) {
     for(size_t i = 0; i < len; i++) {
         uint8_t *rgb = (uint8_t *)((uintptr_t)src + (i * 3));
-#if (NT35310_18BIT_COLOR)
-        uint8_t *d24 = ((uint8_t *)((uintptr_t)dest + (i * 3)));
-        d24[0] = rgb[0] & 0xFC;
-        d24[1] = rgb[1] & 0xFC;
-        d24[2] = rgb[2] & 0xFC;
-#else
-        ((uint16_t *)dest)[i] = RGB(rgb[0], rgb[1], rgb[2]);
-#endif
+        ((nt35310_pixel_t *)dest)[NT35310_PIXEL_INDEX(i)] = RGB(rgb[0], rgb[1], rgb[2]);
     }
 }
 
 void NT35310::writeBuffer(const void *buff, uint16_t width, uint16_t height, uint16_t x, uint16_t y) {
-    this->setArea(x, y, x + width - 1, y + width - 1);
-#if (NT35310_18BIT_COLOR)
-    this->write24((uint32_t *)buff, (width * height));
-#else
-    this->write16((uint16_t *)buff, (width * height));
-#endif
+    this->blit((const nt35310_pixel_t *)buff, width, 0, 0, width, height, x, y);
+}
+
+void NT35310::blit(const nt35310_pixel_t *src, uint16_t stride, uint16_t sx, uint16_t sy,
+                   uint16_t width, uint16_t height, uint16_t x, uint16_t y) {
+    configASSERT(((uintptr_t)src & (NT35310_BUFFER_ALIGN - 1)) == 0);
+
+    if(!width || !height) {
+        return;
+    }
+
+    size_t start = ((size_t)sy * stride) + sx;
+
+    this->setArea(x, y, x + width - 1, y + height - 1);
+    this->pixelBits = 0;
+
+    if(width == stride) {
+        /* Rows are contiguous in source, send as one transfer */
+        this->sendPixels(src, start, (size_t)width * height);
+        return;
+    }
+
+    /* Display continues writing where it left off after each transfer, as
+     * long as no new command is sent. */
+    for(uint16_t i = 0; i < height; i++) {
+        this->sendPixels(src, start, width);
+        start += stride;
+    }
 }
 
 void NT35310::command(nt35310_command_e cmd) {
@@ -125,7 +244,9 @@ void NT35310::command(nt35310_command_e cmd) {
     spi_init(this->spiDev, SPI_WORK_MODE_0, SPI_FF_OCTAL, 8, 0);
     spi_init_non_standard(this->spiDev, 8, 0, 0, SPI_AITM_AS_FRAME_FORMAT);
     /* TODO: Allow selection of DMA channel in constructor or otherwise. */
+    uint64_t start = read_cycle();
     spi_send_data_normal_dma(DMAC_CHANNEL0, this->spiDev, this->spiCS, &cmd, 1, SPI_TRANS_CHAR);
+    this->account(1, start);
 }
 
 void NT35310::write8(const uint8_t *data, size_t len) {
@@ -134,7 +255,9 @@ void NT35310::write8(const uint8_t *data, size_t len) {
     spi_init(this->spiDev, SPI_WORK_MODE_0, SPI_FF_OCTAL, 8, 0);
     spi_init_non_standard(this->spiDev, 8, 0, 0, SPI_AITM_AS_FRAME_FORMAT);
     
+    uint64_t start = read_cycle();
     spi_send_data_normal_dma(DMAC_CHANNEL0, this->spiDev, this->spiCS, data, len, SPI_TRANS_CHAR);
+    this->account(len, start);
 }
 
 void NT35310::write16(const uint16_t *data, size_t len) {
@@ -143,7 +266,9 @@ void NT35310::write16(const uint16_t *data, size_t len) {
     spi_init(this->spiDev, SPI_WORK_MODE_0, SPI_FF_OCTAL, 16, 0);
     spi_init_non_standard(this->spiDev, 16, 0, 0, SPI_AITM_AS_FRAME_FORMAT);
 
+    uint64_t start = read_cycle();
     spi_send_data_normal_dma(DMAC_CHANNEL0, this->spiDev, this->spiCS, data, len, SPI_TRANS_SHORT);
+    this->account(len * 2, start);
 }
 
 void NT35310::write24(const uint32_t *data, size_t len) {
@@ -152,7 +277,9 @@ void NT35310::write24(const uint32_t *data, size_t len) {
     spi_init(this->spiDev, SPI_WORK_MODE_0, SPI_FF_OCTAL, 24, 0);
     spi_init_non_standard(this->spiDev, 0, 24, 0, SPI_AITM_AS_FRAME_FORMAT);
 
-    spi_send_data_normal_dma(DMAC_CHANNEL0, this->spiDev, this->spiCS, data, len, SPI_TRANS_SHORT);
+    uint64_t start = read_cycle();
+    spi_send_data_normal_dma(DMAC_CHANNEL0, this->spiDev, this->spiCS, data, len, SPI_TRANS_INT);
+    this->account(len * 3, start);
 }
 
 void NT35310::write32(const uint32_t *data, size_t len) {
@@ -161,7 +288,69 @@ void NT35310::write32(const uint32_t *data, size_t len) {
     spi_init(this->spiDev, SPI_WORK_MODE_0, SPI_FF_OCTAL, 32, 0);
     spi_init_non_standard(this->spiDev, 0, 32, 0, SPI_AITM_AS_FRAME_FORMAT);
 
+    uint64_t start = read_cycle();
     spi_send_data_normal_dma(DMAC_CHANNEL0, this->spiDev, this->spiCS, data, len, SPI_TRANS_INT);
+    this->account(len * 4, start);
+}
+
+void NT35310::pixelFrames(uint8_t bits) {
+    if(this->pixelBits == bits) {
+        return;
+    }
+
+    gpiohs_set_pin(this->DCNum, GPIO_PV_HIGH);
+
+    spi_init(this->spiDev, SPI_WORK_MODE_0, SPI_FF_OCTAL, bits, 0);
+    if(bits < 24) {
+        spi_init_non_standard(this->spiDev, bits, 0, 0, SPI_AITM_AS_FRAME_FORMAT);
+    } else {
+        spi_init_non_standard(this->spiDev, 0, bits, 0, SPI_AITM_AS_FRAME_FORMAT);
+    }
+    this->pixelBits = bits;
+}
+
+void NT35310::sendPixels(const nt35310_pixel_t *buff, size_t start, size_t len) {
+    /* Only SPI_TRANS_INT is sent straight from the buffer, the SDK copies
+     * narrower data into a temporary buffer of 32-bit words. */
+#if (NT35310_18BIT_COLOR)
+    this->pixelFrames(24);
+
+    uint64_t t = read_cycle();
+    spi_send_data_normal_dma(DMAC_CHANNEL0, this->spiDev, this->spiCS, &buff[start], len, SPI_TRANS_INT);
+    this->account(len * 3, t);
+#else
+    uint32_t single;
+    uint64_t t;
+
+    if(start & 1) {
+        /* Second pixel of a pair, partner is not part of this run */
+        single = buff[NT35310_PIXEL_INDEX(start)];
+        this->pixelFrames(16);
+        t = read_cycle();
+        spi_send_data_normal_dma(DMAC_CHANNEL0, this->spiDev, this->spiCS, &single, 1, SPI_TRANS_INT);
+        this->account(2, t);
+        start++;
+        len--;
+    }
+
+    if(len >= 2) {
+        this->pixelFrames(32);
+        t = read_cycle();
+        spi_send_data_normal_dma(DMAC_CHANNEL0, this->spiDev, this->spiCS,
+                                 &buff[start], len / 2, SPI_TRANS_INT);
+        this->account((len / 2) * 4, t);
+        start += len & ~(size_t)1;
+    }
+
+    if(len & 1) {
+        /* First pixel of a pair, partner is not part of this run */
+        single = buff[NT35310_PIXEL_INDEX(start)];
+        this->pixelFrames(16);
+        t = read_cycle();
+        spi_send_data_normal_dma(DMAC_CHANNEL0, this->spiDev, this->spiCS, &single, 1, SPI_TRANS_INT);
+        this->account(2, t);
+    }
+#endif
 }
 
 void NT35310::fillDMA(uint32_t data, uint8_t bits, size_t len) {
@@ -174,5 +363,138 @@ void NT35310::fillDMA(uint32_t data, uint8_t bits, size_t len) {
         spi_init_non_standard(this->spiDev, 0, bits, 0, SPI_AITM_AS_FRAME_FORMAT);
     }
 
+    uint64_t start = read_cycle();
     spi_fill_data_dma(DMAC_CHANNEL0, this->spiDev, this->spiCS, &data, len);
+    this->account(len * (bits / 8), start);
+}
+
+void NT35310::read(nt35310_command_e cmd, uint8_t *data, size_t len) {
+    this->command(cmd);
+
+    /* Data phase is read with DC high, so it is a separate transfer without
+     * an instruction. */
+    gpiohs_set_pin(this->DCNum, GPIO_PV_HIGH);
+
+    spi_init(this->spiDev, SPI_WORK_MODE_0, SPI_FF_OCTAL, 8, 0);
+    spi_init_non_standard(this->spiDev, 0, 0, 0, SPI_AITM_AS_FRAME_FORMAT);
+
+    uint64_t start = read_cycle();
+    spi_receive_data_multiple(this->spiDev, this->spiCS, NULL, 0, data, len);
+    this->account(len, start);
+}
+
+void NT35310::account(size_t bytes, uint64_t start) {
+    this->stats.transfers++;
+    this->stats.bytes  += bytes;
+    this->stats.cycles += read_cycle() - start;
+}
+
+void NT35310::getStats(nt35310_stats_t *out) {
+    *out = this->stats;
+}
+
+void NT35310::resetStats(void) {
+    memset(&this->stats, 0, sizeof(this->stats));
+}
+
+uint32_t NT35310::getThroughput(void) {
+    if(!this->stats.cycles) {
+        return 0;
+    }
+    return (uint32_t)((this->stats.bytes * sysctl_clock_get_freq(SYSCTL_CLOCK_CPU)) / this->stats.cycles);
+}
+
+uint32_t NT35310::setClockRate(uint32_t rate) {
+    this->clkRate = rate;
+    return spi_set_clk_rate(this->spiDev, rate);
+}
+
+uint32_t NT35310::readID(void) {
+    uint8_t data[4];
+
+    /* First byte is a dummy read */
+    this->read(NT35310_CMD_READ_DISPLAY_ID, data, sizeof(data));
+
+    return ((uint32_t)data[1] << 16) |
+           ((uint32_t)data[2] << 8)  |
+            (uint32_t)data[3];
+}
+
+uint32_t NT35310::selectClockRate(const uint32_t *tiers, size_t count, uint32_t fallback,
+                                  nt35310_clk_probe_t probe, void *ctx) {
+    for(size_t i = 0; i < count; i++) {
+        if(probe(ctx, tiers[i])) {
+            return tiers[i];
+        }
+    }
+
+    return fallback;
+}
+
+bool NT35310::selfTest(void *ctx, uint32_t rate) {
+    NT35310 *lcd = (NT35310 *)ctx;
+
+    static const nt35310_pixel_t colors[4] = {
+        RGB(0xF8, 0x00, 0x00), RGB(0x00, 0xFC, 0x00),
+        RGB(0x00, 0x00, 0xF8), RGB(0xA8, 0x54, 0x50)
+    };
+    alignas(NT35310_BUFFER_ALIGN) nt35310_pixel_t pattern[NT35310_SELFTEST_SIZE * NT35310_SELFTEST_SIZE];
+    /* Memory reads return 3 bytes per pixel regardless of pixel format */
+    uint8_t         readback[1 + (3 * NT35310_SELFTEST_SIZE * NT35310_SELFTEST_SIZE)];
+
+    /* Shift pattern each pass, so stale contents from an earlier pass can't
+     * read back as a match. */
+    static uint8_t pass = 0;
+    pass++;
+    for(size_t i = 0; i < (NT35310_SELFTEST_SIZE * NT35310_SELFTEST_SIZE); i++) {
+        pattern[NT35310_PIXEL_INDEX(i)] = colors[(i + (i / NT35310_SELFTEST_SIZE) + pass) % 4];
+    }
+
+    uint32_t id = lcd->readID();
+
+    lcd->setClockRate(rate);
+    bool ok = (lcd->readID() == id);
+    if(ok) {
+        lcd->writeBuffer(pattern, NT35310_SELFTEST_SIZE, NT35310_SELFTEST_SIZE, 0, 0);
+
+        lcd->setArea(0, 0, NT35310_SELFTEST_SIZE - 1, NT35310_SELFTEST_SIZE - 1);
+        /* setArea leaves a write started, RAMRD restarts at the window origin */
+        lcd->read(NT35310_CMD_READ_MEMORY_START, readback, sizeof(readback));
+
+        /* First byte is a dummy read */
+        for(size_t i = 0; ok && (i < (NT35310_SELFTEST_SIZE * NT35310_SELFTEST_SIZE)); i++) {
+            const uint8_t *px = &readback[1 + (i * 3)];
+            ok = (RGB(px[0], px[1], px[2]) == pattern[NT35310_PIXEL_INDEX(i)]);
+        }
+    }
+
+    lcd->setClockRate(NT35310_CLK_RATE_DEFAULT);
+    return ok;
+}
+
+bool NT35310::readbackAvailable(void) {
+    uint32_t rate = this->clkRate;
+
+    this->setClockRate(NT35310_CLK_RATE_DEFAULT);
+    uint32_t id = this->readID();
+    this->setClockRate(rate);
+
+    /* All zeros or ones is a floating bus, not an ID */
+    return (id != 0) && (id != 0xFFFFFF);
+}
+
+uint32_t NT35310::autoClockRate(void) {
+    static const uint32_t tiers[] = NT35310_CLK_RATE_TIERS;
+
+    if(!this->readbackAvailable()) {
+        this->setClockRate(NT35310_CLK_RATE_DEFAULT);
+        return NT35310_CLK_RATE_DEFAULT;
+    }
+
+    uint32_t rate = NT35310::selectClockRate(tiers, sizeof(tiers) / sizeof(tiers[0]),
+                                             NT35310_CLK_RATE_DEFAULT,
+                                             &NT35310::selfTest, this);
+    this->setClockRate(rate);
+
+    return rate;
 }
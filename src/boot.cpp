@@ -0,0 +1,57 @@
+#include <stdio.h>
+
+#include <sysctl.h>
+
+#include <boot.hpp>
+
+static const char *boot_event_names[BOOT_EVENT_MAX] = {
+    "start",
+    "decoder ready",
+    "core 1 start",
+    "lcd reset",
+    "lcd ready",
+    "splash",
+    "first reading"
+};
+
+/* Written from both cores, but each event is only ever marked by one. */
+static volatile uint64_t boot_timeline[BOOT_EVENT_MAX];
+
+uint64_t boot_time_us(void) {
+    return sysctl_get_time_us();
+}
+
+void boot_mark(boot_event_e event) {
+    if(event >= BOOT_EVENT_MAX) {
+        return;
+    }
+    if(!boot_timeline[event]) {
+        boot_timeline[event] = boot_time_us();
+    }
+}
+
+uint64_t boot_get(boot_event_e event) {
+    if(event >= BOOT_EVENT_MAX) {
+        return 0;
+    }
+    return boot_timeline[event];
+}
+
+void boot_report(void) {
+    uint64_t start = boot_timeline[BOOT_EVENT_START];
+
+    printf("Boot timeline:\r\n");
+    for(int i = 0; i < BOOT_EVENT_MAX; i++) {
+        if(boot_timeline[i]) {
+            printf("  %-14s %8lu us\r\n", boot_event_names[i],
+                   (unsigned long)(boot_timeline[i] - start));
+        } else {
+            printf("  %-14s        -\r\n", boot_event_names[i]);
+        }
+    }
+
+    if(boot_timeline[BOOT_EVENT_FIRST_READING]) {
+        printf("Time to first reading: %lu us\r\n",
+               (unsigned long)(boot_timeline[BOOT_EVENT_FIRST_READING] - start));
+    }
+}
@@ -0,0 +1,104 @@
+#include <string.h>
+
+#include <fixlog.hpp>
+
+/**
+ * Natural logarithm for x in [1, 2], for compile-time table generation.
+ * Uses ln(x) = 2 * atanh((x - 1) / (x + 1)), which converges quickly here.
+ */
+static constexpr double fixlog_ct_ln(double x) {
+    double y   = (x - 1.0) / (x + 1.0);
+    double y2  = y * y;
+    double sum = 0.0;
+    for(int k = 0; k < 16; k++) {
+        sum += y / (2 * k + 1);
+        y   *= y2;
+    }
+    return 2.0 * sum;
+}
+
+/**
+ * Exponent for x in [0, ln(2)], for compile-time table generation.
+ */
+static constexpr double fixlog_ct_exp(double x) {
+    double term = 1.0;
+    double sum  = 1.0;
+    for(int k = 1; k < 20; k++) {
+        term *= x / k;
+        sum  += term;
+    }
+    return sum;
+}
+
+static constexpr double FIXLOG_CT_LN2 = 0.693147180559945309417;
+
+struct fixlog_table_t {
+    int32_t v[FIXLOG_TABLE_SIZE];
+
+    /**
+     * @param exp false: log2(1 + i/N), true: 2^(i/N)
+     */
+    constexpr fixlog_table_t(bool exp) : v() {
+        for(int i = 0; i < FIXLOG_TABLE_SIZE; i++) {
+            double x = (double)i / (FIXLOG_TABLE_SIZE - 1);
+            double r = exp ? fixlog_ct_exp(x * FIXLOG_CT_LN2)
+                           : fixlog_ct_ln(1.0 + x) / FIXLOG_CT_LN2;
+            v[i] = (int32_t)((r * FIXLOG_ONE) + 0.5);
+        }
+    }
+};
+
+static constexpr fixlog_table_t fixlog_log2_table(false);
+static constexpr fixlog_table_t fixlog_exp2_table(true);
+
+static_assert(fixlog_log2_table.v[FIXLOG_TABLE_SIZE - 1] == FIXLOG_ONE,     "log2 table end");
+static_assert(fixlog_exp2_table.v[FIXLOG_TABLE_SIZE - 1] == 2 * FIXLOG_ONE, "exp2 table end");
+
+int32_t fixlog_log2(float x) {
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+
+    int32_t exp = (int32_t)((bits >> 23) & 0xFF);
+    if((bits & 0x80000000) || (exp == 0)) {
+        /* Negative, zero, or denormal */
+        return FIXLOG_INVALID;
+    }
+    exp -= 127;
+
+    /* Top mantissa bits index the table, the rest interpolate */
+    const int      shift = 23 - FIXLOG_TABLE_BITS;
+    uint32_t       mant  = bits & 0x7FFFFF;
+    uint32_t       idx   = mant >> shift;
+    int32_t        frac  = (int32_t)(mant & ((1UL << shift) - 1));
+    const int32_t *tab   = fixlog_log2_table.v;
+
+    int32_t res = tab[idx] + (int32_t)(((int64_t)(tab[idx + 1] - tab[idx]) * frac) >> shift);
+
+    return (exp * FIXLOG_ONE) + res;
+}
+
+float fixlog_exp2(int32_t x) {
+    int32_t  ipart = x >> FIXLOG_FRAC_BITS; /* Floor, including for negative values */
+    uint32_t fpart = (uint32_t)x & (FIXLOG_ONE - 1);
+
+    if(ipart > 127) {
+        ipart = 127;
+        fpart = FIXLOG_ONE - 1;
+    } else if(ipart < -126) {
+        return 0.0f;
+    }
+
+    const int      shift = FIXLOG_FRAC_BITS - FIXLOG_TABLE_BITS;
+    uint32_t       idx   = fpart >> shift;
+    int32_t        frac  = (int32_t)(fpart & ((1UL << shift) - 1));
+    const int32_t *tab   = fixlog_exp2_table.v;
+
+    /* Result in [1, 2), Q16.16 */
+    int32_t mant = tab[idx] + (((tab[idx + 1] - tab[idx]) * frac) >> shift);
+
+    uint32_t bits = ((uint32_t)(ipart + 127) << 23) |
+                    (((uint32_t)(mant - FIXLOG_ONE) << (23 - FIXLOG_FRAC_BITS)) & 0x7FFFFF);
+    float res;
+    memcpy(&res, &bits, sizeof(res));
+    return res;
+}
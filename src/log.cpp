@@ -0,0 +1,122 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <log.hpp>
+
+log_queue_t log_queues[LOG_CORES];
+
+#if (!LOG_BINARY)
+#define LOG_FMT_STRING(id, fmt) fmt,
+static const char *log_formats[LOG_FMT_MAX] = {
+    LOG_FORMATS(LOG_FMT_STRING)
+};
+#undef LOG_FMT_STRING
+
+/**
+ * Format a single log entry and print it to the serial port.
+ *
+ * Each conversion is formatted seperately, as the argument types are only
+ * known by parsing the format string.
+ *
+ * @param ent Entry to print
+ */
+static void log_print(const log_entry_t *ent) {
+    char        line[128];
+    char        spec[16];
+    size_t      pos = 0;
+    uint8_t     arg = 0;
+    const char *fmt = (ent->fmt < LOG_FMT_MAX) ? log_formats[ent->fmt] : "<bad log format>";
+
+    while(*fmt && (pos < (sizeof(line) - 1))) {
+        if(*fmt != '%') {
+            line[pos++] = *fmt++;
+            continue;
+        }
+        if(fmt[1] == '%') {
+            line[pos++] = '%';
+            fmt += 2;
+            continue;
+        }
+
+        /* Copy flags, width and precision, dropping length modifiers */
+        size_t slen = 0;
+        spec[slen++] = *fmt++;
+        while(*fmt && strchr("-+ #0123456789.hlzjtL", *fmt)) {
+            if(!strchr("hlzjtL", *fmt) && (slen < (sizeof(spec) - 2))) {
+                spec[slen++] = *fmt;
+            }
+            fmt++;
+        }
+        if(!*fmt) {
+            break;
+        }
+        char conv = *fmt++;
+        spec[slen++] = conv;
+        spec[slen]   = '\0';
+
+        uint32_t raw = (arg < ent->nargs) ? ent->args[arg] : 0;
+        arg++;
+
+        int ret;
+        if(strchr("fFeEgGaA", conv)) {
+            float val;
+            memcpy(&val, &raw, sizeof(val));
+            ret = snprintf(&line[pos], sizeof(line) - pos, spec, (double)val);
+        } else if(strchr("di", conv)) {
+            ret = snprintf(&line[pos], sizeof(line) - pos, spec, (int)raw);
+        } else {
+            ret = snprintf(&line[pos], sizeof(line) - pos, spec, (unsigned)raw);
+        }
+        if(ret < 0) {
+            break;
+        }
+        pos += (size_t)ret;
+        if(pos > (sizeof(line) - 1)) {
+            pos = sizeof(line) - 1;
+        }
+    }
+    line[pos] = '\0';
+
+    printf("%s\r\n", line);
+}
+#else
+/**
+ * Emit a single log entry as a binary frame.
+ *
+ * Frame: SYNC0, SYNC1, then the entry header and used arguments, little-endian.
+ *
+ * @param ent Entry to emit
+ */
+static void log_print(const log_entry_t *ent) {
+    static const uint8_t sync[2] = { LOG_FRAME_SYNC0, LOG_FRAME_SYNC1 };
+
+    fwrite(sync, 1, sizeof(sync), stdout);
+    fwrite(ent, 1, offsetof(log_entry_t, args) + (ent->nargs * sizeof(uint32_t)), stdout);
+    fflush(stdout);
+}
+#endif
+
+void log_flush(void) {
+    static uint32_t dropReported[LOG_CORES];
+
+    for(int core = 0; core < LOG_CORES; core++) {
+        log_queue_t *q    = &log_queues[core];
+        uint32_t     tail = q->tail;
+        uint32_t     head = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+
+        while(tail != head) {
+            log_print(&q->entries[tail & (LOG_QUEUE_SIZE - 1)]);
+            tail++;
+            __atomic_store_n(&q->tail, tail, __ATOMIC_RELEASE);
+        }
+
+        uint32_t dropped = q->dropped;
+        if(dropped != dropReported[core]) {
+            /* Not queued, as this is already running on the consuming core */
+            printf("log: core %d dropped %lu entries\r\n", core,
+                   (unsigned long)(dropped - dropReported[core]));
+            dropReported[core] = dropped;
+        }
+    }
+}
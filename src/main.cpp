@@ -1,3 +1,5 @@
+#include <math.h>
+
 #include <bsp.h>
 #include <gpio.h>
 #include <fpioa.h>
@@ -5,6 +7,12 @@
 #include <sysctl.h>
 
 #include <pins.h>
+#include <log.hpp>
+#include <boot.hpp>
+#include <Filter.hpp>
+#include <SevenSegment.hpp>
+#include <DisplayMirror.hpp>
+#include <IndexedFramebuffer.hpp>
 #include <NT35310.hpp>
 #include <Fluke8050A.hpp>
 
@@ -19,49 +27,242 @@
  * Core 1:
  *   LCD control
  *   8050A value display
+ *   Log output
+ *   Display mirroring over UART
+ *
+ * Boot order:
+ *   Core 0 brings up the 8050A decoder before anything else, then starts
+ *   core 1. Core 1 configures the LCD pins and steps through the LCD power-up
+ *   sequence without blocking core 0, drawing the splash screen as soon as the
+ *   LCD accepts pixel data. The splash is replaced by the first reading as
+ *   soon as core 1 sees it, polling every UI_POLL_MS.
  */
 
-static int core1_function(void *ctx) {
-    NT35310 lcd(LCD_SPI_DEV, SPI_CHIP_SELECT_0,
-                LCD_GPIOHS_RST, LCD_GPIOHS_DC,
-                LCD_WIDTH, LCD_HEIGHT);
-    
-    (void)ctx;
-    uint64_t core = current_coreid();
-    printf("Core %ld Hello world\r\n", core);
+static fluke_8050a_pins_t flukePins = {
+    .dp  = FLUKE8050_GPIOHS_DP,
+    .hv  = FLUKE8050_GPIOHS_HV,
+    .w   = FLUKE8050_GPIOHS_W,
+    .x   = FLUKE8050_GPIOHS_X,
+    .y   = FLUKE8050_GPIOHS_Y,
+    .z   = FLUKE8050_GPIOHS_Z,
+    .st0 = FLUKE8050_GPIOHS_ST0,
+    .st1 = FLUKE8050_GPIOHS_ST1,
+    .st2 = FLUKE8050_GPIOHS_ST2,
+    .st3 = FLUKE8050_GPIOHS_ST3,
+    .st4 = FLUKE8050_GPIOHS_ST4
+};
 
-    lcd.init();
-    lcd.fill(RGB(0,0,0));
+static Fluke8050A fluke(&flukePins);
 
-    while(1) {
-        msleep(250);
-        gpio_set_pin(LED_GPIO_G, GPIO_PV_HIGH);
-        lcd.fillArea(RGB(255,0,0), 0, 0, 100, 100);
-        msleep(250);
-        gpio_set_pin(LED_GPIO_G, GPIO_PV_LOW);
-        lcd.fillArea(RGB(0,255,0), 50, 75, 150, 175);
-        msleep(250);
-        lcd.fillArea(RGB(0,0,255), 100, 150, 200, 250);
+/* UI dimensions, in the configured LCD orientation */
+#define UI_LANDSCAPE ((LCD_ROTATION == NT35310_ROTATION_90) || \
+                      (LCD_ROTATION == NT35310_ROTATION_270))
+#define UI_WIDTH     (UI_LANDSCAPE ? LCD_HEIGHT : LCD_WIDTH)
+#define UI_HEIGHT    (UI_LANDSCAPE ? LCD_WIDTH  : LCD_HEIGHT)
+
+typedef enum {
+    UI_COLOR_BACKGROUND = 0,
+    UI_COLOR_SEGMENT_ON,
+    UI_COLOR_SEGMENT_OFF
+} ui_color_e;
+
+/* Core 1 loop timing. The loop polls for new readings every UI_POLL_MS, so a
+ * reading is drawn at most that long after it is decoded, plus the time of a
+ * mirror update if one is in progress (see MIRROR_BUDGET_US). */
+#define UI_POLL_MS       1
+#define UI_MIRROR_US     20000   /*!< Interval between mirror updates */
+#define UI_STATS_US      1000000 /*!< Interval between LCD statistics logs */
+
+static const sevenseg_style_t uiReadingStyle = {
+    .width     = 32,
+    .height    = 64,
+    .thickness = 6,
+    .spacing   = 8,
+    .on        = UI_COLOR_SEGMENT_ON,
+    .off       = UI_COLOR_SEGMENT_OFF
+};
+
+/* Values derived from the reading, drawn in rows below it while REL or dB is
+ * active. Each row is a label cell followed by a reading. */
+static const sevenseg_style_t uiDerivedStyle = {
+    .width     = 16,
+    .height    = 32,
+    .thickness = 3,
+    .spacing   = 6,
+    .on        = UI_COLOR_SEGMENT_ON,
+    .off       = UI_COLOR_SEGMENT_OFF
+};
+
+#define UI_DERIVED_ROWS   3 /*!< Maximum number of derived value rows */
+#define UI_DERIVED_GAP    8 /*!< Vertical gap above each derived row, in pixels */
+#define UI_DERIVED_PITCH  (uiDerivedStyle.height + UI_DERIVED_GAP)
+#define UI_DERIVED_WIDTH  (uiDerivedStyle.width + uiDerivedStyle.spacing + \
+                           sevenseg_reading_width(&uiDerivedStyle))
+
+/* Reading and derived rows are centered together */
+#define UI_READING_X      ((UI_WIDTH  - sevenseg_reading_width(&uiReadingStyle)) / 2)
+#define UI_READING_Y      ((UI_HEIGHT - (uiReadingStyle.height + (UI_DERIVED_ROWS * UI_DERIVED_PITCH))) / 2)
+#define UI_DERIVED_X      ((UI_WIDTH - UI_DERIVED_WIDTH) / 2)
+#define UI_DERIVED_Y(row) (UI_READING_Y + uiReadingStyle.height + UI_DERIVED_GAP + ((row) * UI_DERIVED_PITCH))
+
+typedef IndexedFramebuffer<4, UI_WIDTH, UI_HEIGHT> ui_framebuffer_t;
+
+/* Powers of ten, indexed by number of decimals */
+static const float uiDecimalScale[SEVENSEG_DIGITS] = { 1, 10, 100, 1000, 10000 };
+
+/* UI framebuffer, only touched by core 1 */
+static ui_framebuffer_t ui;
+
+/* UART sends are polled, so the mirror holds up the UI loop while sending.
+ * Each update is limited to about MIRROR_BUDGET_US of line time (10 bits per
+ * byte), plus at most one tile, a small fraction of UI_MIRROR_US. */
+#define MIRROR_BUDGET_US 2000
+#define MIRROR_BUDGET    (((MIRROR_BAUD / 10) * MIRROR_BUDGET_US) / 1000000)
+
+/* Constructed after ui, so its format can be taken from it */
+static uint8_t       mirrorShadow[ui_framebuffer_t::ROW_BYTES * UI_HEIGHT];
+static DisplayMirror mirror(MIRROR_UART_DEV, MIRROR_BAUD, ui.getBpp(),
+                            ui.getWidth(), ui.getHeight(), mirrorShadow);
+
+/* Reading smoothing, only touched by core 1. Bits are stage positions in
+ * readingFilter. */
+#define READING_FILTER_MEDIAN   (1U << 0)
+#define READING_FILTER_AVERAGE  (1U << 1)
+#define READING_FILTER_EXP      (1U << 2)
+#define READING_FILTER_SETTLE   (1U << 3)
+
+/* Stages applied to readings, may be overridden at build time. Bypassed
+ * stages pass samples through, so with none enabled the raw reading is
+ * shown. Without READING_FILTER_SETTLE, readings are never reported as
+ * settled. */
+#ifndef READING_FILTERS
+#define READING_FILTERS (READING_FILTER_MEDIAN | READING_FILTER_AVERAGE | \
+                         READING_FILTER_EXP    | READING_FILTER_SETTLE)
+#endif
+
+static FilterChain<FilterMedian<5>,
+                   FilterMovingAverage<4>,
+                   FilterExponential<2>,
+                   FilterSettle<4, 2 * FILTER_ONE>> readingFilter;
+
+static uint32_t readingSamples = 0; /*!< Sample count at last filter update */
+static float    readingScale   = 0; /*!< Scale at last filter update, to detect range changes */
+static int32_t  readingCounts  = 0; /*!< Filtered reading, rounded to counts */
+static float    readingValue   = 0; /*!< Filtered reading */
+static uint8_t  readingStatus  = 0; /*!< Status at last filter update, see fluke_8050a_status_e */
+
+static derived_value_t readingDerived; /*!< Values derived from the last unfiltered reading */
+
+/**
+ * Feed any new reading through the filter chain.
+ *
+ * @return true if a new reading was processed, else false
+ */
+static bool reading_update(void) {
+    int16_t  counts;
+    float    scale;
+    uint32_t samples = fluke.getReading(&counts, &scale);
+    if(samples == readingSamples) {
+        return false;
+    }
+    readingSamples = samples;
+
+    if(scale != readingScale) {
+        /* Range changed, old samples no longer comparable */
+        readingFilter.reset();
+        readingScale = scale;
     }
+
+    int32_t out = readingFilter.process((int32_t)counts * FILTER_ONE);
+    readingCounts = (out + (FILTER_ONE / 2)) >> FILTER_FRAC_BITS;
+    readingValue  = (float)out / (FILTER_ONE * scale);
+
+    readingStatus = fluke.getStatus();
+    fluke.getDerived(&readingDerived);
+    if(readingStatus & (FLUKE8050A_STATUS_REL | FLUKE8050A_STATUS_DB)) {
+        log_msg(LOG_FMT_FLUKE_DERIVED, readingDerived.delta, readingDerived.percent,
+                readingDerived.dbRel, readingDerived.level);
+    }
+
+    return true;
 }
 
-static void k210_init(void) {
-    sysctl_pll_set_freq(SYSCTL_PLL0, 400000000);
-    gpio_init();
+/**
+ * Draw a reading to the UI framebuffer, centered on the screen. Filtered
+ * readings are drawn in the same units as the 8050A displays them.
+ *
+ * @param counts Reading, ignoring the decimal point
+ * @param scale  Divisor to convert counts to value
+ */
+static void ui_draw_reading(int32_t counts, float scale) {
+    uint8_t decimals = 0;
+    for(float s = scale; s > 1.5f; s /= 10) {
+        decimals++;
+    }
 
-    /* Initialize RGB status LED */
-    fpioa_set_function(LED_PIN_R, (fpioa_function_t)(FUNC_GPIO0 + LED_GPIO_R));
-    fpioa_set_function(LED_PIN_G, (fpioa_function_t)(FUNC_GPIO0 + LED_GPIO_G));
-    fpioa_set_function(LED_PIN_B, (fpioa_function_t)(FUNC_GPIO0 + LED_GPIO_B));
-    
-    gpio_set_drive_mode(LED_GPIO_R, GPIO_DM_OUTPUT);
-    gpio_set_drive_mode(LED_GPIO_G, GPIO_DM_OUTPUT);
-    gpio_set_drive_mode(LED_GPIO_B, GPIO_DM_OUTPUT);
+    sevenseg_reading(ui, UI_READING_X, UI_READING_Y, &uiReadingStyle, counts, decimals);
+}
 
-    gpio_set_pin(LED_GPIO_R, GPIO_PV_HIGH);
-    gpio_set_pin(LED_GPIO_G, GPIO_PV_HIGH);
-    gpio_set_pin(LED_GPIO_B, GPIO_PV_HIGH);
-    
+/**
+ * Draw a labelled derived value in the given row, with as many decimals as
+ * fit. Values that cannot be shown (NAN, or too large) are drawn as dashes.
+ *
+ * @param row   Row below the reading, less than UI_DERIVED_ROWS
+ * @param label Label segments, see SEVENSEG_LETTER_*
+ * @param value Value to draw
+ */
+static void ui_draw_derived_row(uint8_t row, uint8_t label, float value) {
+    int32_t counts   = SEVENSEG_MAX_COUNT + 1;
+    uint8_t decimals = 0;
+    if(!isnan(value)) {
+        float mag = fabsf(value);
+        for(decimals = SEVENSEG_DIGITS - 1; decimals > 0; decimals--) {
+            if(mag < ((float)SEVENSEG_MAX_COUNT / uiDecimalScale[decimals])) {
+                break;
+            }
+        }
+        float scaled = value * uiDecimalScale[decimals];
+        if(fabsf(scaled) <= SEVENSEG_MAX_COUNT) {
+            counts = (int32_t)lroundf(scaled);
+        }
+    }
+
+    uint16_t y = UI_DERIVED_Y(row);
+    sevenseg_cell(ui, UI_DERIVED_X, y, &uiDerivedStyle, label);
+    sevenseg_reading(ui, UI_DERIVED_X + uiDerivedStyle.width + uiDerivedStyle.spacing, y,
+                     &uiDerivedStyle, counts, decimals);
+}
+
+/**
+ * Draw values derived from the reading below it. While REL is active these
+ * are the deviation, the deviation in percent and the ratio in dB. While dB
+ * is active the level is drawn in volts. Rows no longer in use are cleared.
+ *
+ * @param status  8050A status, see fluke_8050a_status_e
+ * @param derived Values derived from the reading
+ */
+static void ui_draw_derived(uint8_t status, const derived_value_t *derived) {
+    static uint8_t lastRows = 0;
+    uint8_t        rows     = 0;
+
+    if((status & FLUKE8050A_STATUS_REL) && !(status & FLUKE8050A_STATUS_DB)) {
+        ui_draw_derived_row(rows++, SEVENSEG_LETTER_D, derived->delta);
+        ui_draw_derived_row(rows++, SEVENSEG_LETTER_P, derived->percent);
+        ui_draw_derived_row(rows++, SEVENSEG_LETTER_B, derived->dbRel);
+    } else if(status & FLUKE8050A_STATUS_DB) {
+        /* In dB the reading already is the (relative) level */
+        ui_draw_derived_row(rows++, SEVENSEG_LETTER_U, derived->level);
+    }
+
+    if(lastRows > rows) {
+        ui.fillRect(UI_DERIVED_X, UI_DERIVED_Y(rows) - UI_DERIVED_GAP,
+                    UI_DERIVED_X + UI_DERIVED_WIDTH - 1, UI_DERIVED_Y(lastRows) - 1,
+                    UI_COLOR_BACKGROUND);
+    }
+    lastRows = rows;
+}
+
+static void lcd_pins_init(void) {
     /* Initialize LCD SPI pins */
     fpioa_set_function(LCD_PIN_CS,  FUNC_SPI0_SS0);
     fpioa_set_function(LCD_PIN_WR,  FUNC_SPI0_SCLK);
@@ -72,6 +273,110 @@ static void k210_init(void) {
     sysctl_set_spi0_dvp_data(1);
     sysctl_set_power_mode(SYSCTL_POWER_BANK6, SYSCTL_POWER_V18);
     sysctl_set_power_mode(SYSCTL_POWER_BANK7, SYSCTL_POWER_V18);
+}
+
+static void mirror_pins_init(void) {
+    fpioa_set_function(MIRROR_PIN_TX, FUNC_UART1_TX);
+    fpioa_set_function(MIRROR_PIN_RX, FUNC_UART1_RX);
+}
+
+static void lcd_splash(NT35310 &lcd) {
+    /* Only uses DMA fills, so it can be drawn without any image data */
+    lcd.fill(RGB(0,0,0));
+    lcd.fillArea(RGB(255,0,0), 0,   0, lcd.getWidth() - 1,   7);
+    lcd.fillArea(RGB(0,255,0), 0,   8, lcd.getWidth() - 1,  15);
+    lcd.fillArea(RGB(0,0,255), 0,  16, lcd.getWidth() - 1,  23);
+}
+
+static int core1_function(void *ctx) {
+    NT35310 lcd(LCD_SPI_DEV, SPI_CHIP_SELECT_0,
+                LCD_GPIOHS_RST, LCD_GPIOHS_DC,
+                LCD_WIDTH, LCD_HEIGHT);
+    
+    (void)ctx;
+    boot_mark(BOOT_EVENT_CORE1_START);
+    log_msg(LOG_FMT_HELLO, current_coreid());
+
+    readingFilter.setEnabled(READING_FILTERS);
+
+    lcd_pins_init();
+    lcd.setOrientation(LCD_ROTATION, LCD_MIRROR);
+    lcd.initStart();
+    while(!lcd.initPoll());
+#if (LCD_CLK_AUTO)
+    if(lcd.readbackAvailable()) {
+        log_msg(LOG_FMT_LCD_CLOCK, lcd.autoClockRate());
+    } else {
+        log_msg(LOG_FMT_LCD_CLOCK_FIXED, lcd.setClockRate(LCD_CLK_RATE));
+    }
+#else
+    log_msg(LOG_FMT_LCD_CLOCK, lcd.setClockRate(LCD_CLK_RATE));
+#endif
+
+    lcd_splash(lcd);
+    boot_mark(BOOT_EVENT_SPLASH);
+
+    mirror_pins_init();
+    mirror.init();
+
+    ui.setPalette(UI_COLOR_BACKGROUND,  RGB(0,0,0));
+    ui.setPalette(UI_COLOR_SEGMENT_ON,  RGB(255,255,255));
+    ui.setPalette(UI_COLOR_SEGMENT_OFF, RGB(24,24,24));
+
+    lcd.resetStats();
+
+    uint64_t nextMirror = 0;
+    uint64_t nextStats  = 0;
+    bool     led        = false;
+    while(1) {
+        if(reading_update()) {
+            log_msg(LOG_FMT_READING_FILTERED, readingValue,
+                    (READING_FILTERS & READING_FILTER_SETTLE) &&
+                    readingFilter.stage<3>().isSettled());
+
+            ui_draw_reading(readingCounts, readingScale);
+            ui_draw_derived(readingStatus, &readingDerived);
+            ui.flush(lcd);
+            if(!boot_get(BOOT_EVENT_FIRST_READING)) {
+                boot_mark(BOOT_EVENT_FIRST_READING);
+                boot_report();
+            }
+
+            led = !led;
+            gpio_set_pin(LED_GPIO_G, led ? GPIO_PV_HIGH : GPIO_PV_LOW);
+        }
+
+        /* High voltage warning, only needs a palette change */
+        ui.setPalette(UI_COLOR_BACKGROUND,
+                      (fluke.getStatus() & FLUKE8050A_STATUS_HV) ? RGB(96,0,0) : RGB(0,0,0));
+
+        uint64_t now = boot_time_us();
+        if(boot_get(BOOT_EVENT_FIRST_READING)) {
+            /* Splash stays up until there is a reading to show */
+            ui.flush(lcd);
+
+            if(now >= nextMirror) {
+                mirror.update(ui.getPixels(), ui.getPalette(), MIRROR_BUDGET);
+                nextMirror = now + UI_MIRROR_US;
+            }
+        }
+
+        if(now >= nextStats) {
+            nt35310_stats_t stats;
+            lcd.getStats(&stats);
+            log_msg(LOG_FMT_LCD_STATS, stats.transfers, lcd.getThroughput());
+            nextStats = now + UI_STATS_US;
+        }
+
+        log_flush();
+        msleep(UI_POLL_MS);
+    }
+}
+
+static void k210_init(void) {
+    sysctl_pll_set_freq(SYSCTL_PLL0, 400000000);
+    boot_mark(BOOT_EVENT_START);
+    gpio_init();
 
     /* Initialize 8050A pins */
     fpioa_set_function(FLUKE8050_PIN_DP,  (fpioa_function_t)(FUNC_GPIOHS0 + FLUKE8050_GPIOHS_DP));
@@ -85,33 +390,32 @@ static void k210_init(void) {
     fpioa_set_function(FLUKE8050_PIN_ST2, (fpioa_function_t)(FUNC_GPIOHS0 + FLUKE8050_GPIOHS_ST2));
     fpioa_set_function(FLUKE8050_PIN_ST3, (fpioa_function_t)(FUNC_GPIOHS0 + FLUKE8050_GPIOHS_ST3));
     fpioa_set_function(FLUKE8050_PIN_ST4, (fpioa_function_t)(FUNC_GPIOHS0 + FLUKE8050_GPIOHS_ST4));
+
+    /* Initialize RGB status LED */
+    fpioa_set_function(LED_PIN_R, (fpioa_function_t)(FUNC_GPIO0 + LED_GPIO_R));
+    fpioa_set_function(LED_PIN_G, (fpioa_function_t)(FUNC_GPIO0 + LED_GPIO_G));
+    fpioa_set_function(LED_PIN_B, (fpioa_function_t)(FUNC_GPIO0 + LED_GPIO_B));
+    
+    gpio_set_drive_mode(LED_GPIO_R, GPIO_DM_OUTPUT);
+    gpio_set_drive_mode(LED_GPIO_G, GPIO_DM_OUTPUT);
+    gpio_set_drive_mode(LED_GPIO_B, GPIO_DM_OUTPUT);
+
+    gpio_set_pin(LED_GPIO_R, GPIO_PV_HIGH);
+    gpio_set_pin(LED_GPIO_G, GPIO_PV_HIGH);
+    gpio_set_pin(LED_GPIO_B, GPIO_PV_HIGH);
 }
 
 int main(void)
 {
     k210_init();
 
-    uint64_t core = current_coreid();
-    printf("Core %ld Hello world\r\n", core);
-    register_core1(core1_function, NULL);
+    /* Start decoding as early as possible, LCD bring-up happens on core 1 */
+    fluke.init();
+    boot_mark(BOOT_EVENT_DECODER_READY);
 
-    fluke_8050a_pins_t flukePins = {
-        .dp  = FLUKE8050_GPIOHS_DP,
-        .hv  = FLUKE8050_GPIOHS_HV,
-        .w   = FLUKE8050_GPIOHS_W,
-        .x   = FLUKE8050_GPIOHS_X,
-        .y   = FLUKE8050_GPIOHS_Y,
-        .z   = FLUKE8050_GPIOHS_Z,
-        .st0 = FLUKE8050_GPIOHS_ST0,
-        .st1 = FLUKE8050_GPIOHS_ST1,
-        .st2 = FLUKE8050_GPIOHS_ST2,
-        .st3 = FLUKE8050_GPIOHS_ST3,
-        .st4 = FLUKE8050_GPIOHS_ST4
-    };
-
-    Fluke8050A fluke(&flukePins);
+    register_core1(core1_function, NULL);
 
-    fluke.init();
+    log_msg(LOG_FMT_HELLO, current_coreid());
 
     while(1) {
         msleep(500);
@@ -0,0 +1,16 @@
+#ifndef MOCK_DMAC_H
+#define MOCK_DMAC_H
+
+/* Host stand-in for the Kendryte SDK's dmac.h, see mock_sdk.hpp */
+
+typedef enum {
+    DMAC_CHANNEL0,
+    DMAC_CHANNEL1,
+    DMAC_CHANNEL2,
+    DMAC_CHANNEL3,
+    DMAC_CHANNEL4,
+    DMAC_CHANNEL5,
+    DMAC_CHANNEL_MAX
+} dmac_channel_number_t;
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef MOCK_ENCODING_H
+#define MOCK_ENCODING_H
+
+/* Host stand-in for the Kendryte SDK's encoding.h, see mock_sdk.hpp */
+
+#include <stdint.h>
+
+uint64_t mock_read_cycle(void);
+
+#define read_cycle() mock_read_cycle()
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef MOCK_FPIOA_H
+#define MOCK_FPIOA_H
+
+/* Host stand-in for the Kendryte SDK's fpioa.h, nothing is used on the host */
+
+#endif
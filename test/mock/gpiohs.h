@@ -0,0 +1,23 @@
+#ifndef MOCK_GPIOHS_H
+#define MOCK_GPIOHS_H
+
+/* Host stand-in for the Kendryte SDK's gpiohs.h, see mock_sdk.hpp */
+
+#include <stdint.h>
+
+typedef enum {
+    GPIO_DM_INPUT,
+    GPIO_DM_INPUT_PULL_DOWN,
+    GPIO_DM_INPUT_PULL_UP,
+    GPIO_DM_OUTPUT
+} gpio_drive_mode_t;
+
+typedef enum {
+    GPIO_PV_LOW,
+    GPIO_PV_HIGH
+} gpio_pin_value_t;
+
+void gpiohs_set_drive_mode(uint8_t pin, gpio_drive_mode_t mode);
+void gpiohs_set_pin(uint8_t pin, gpio_pin_value_t value);
+
+#endif
@@ -0,0 +1,154 @@
+#include <string.h>
+
+#include <sleep.h>
+#include <sysctl.h>
+#include <encoding.h>
+
+#include "mock_sdk.hpp"
+
+#define MOCK_CPU_FREQ 400000000
+
+mock_sdk_t mock_sdk;
+
+void mock_sdk_reset(void) {
+    memset(&mock_sdk, 0, sizeof(mock_sdk));
+}
+
+void spi_init(spi_device_num_t spi_num, spi_work_mode_t work_mode, spi_frame_format_t frame_format,
+              size_t data_bit_length, uint32_t endian) {
+    (void)spi_num; (void)work_mode; (void)frame_format; (void)endian;
+    mock_sdk.frameBits = data_bit_length;
+}
+
+void spi_init_non_standard(spi_device_num_t spi_num, uint32_t instruction_length, uint32_t address_length,
+                           uint32_t wait_cycles, spi_instruction_address_trans_mode_t instruction_address_trans_mode) {
+    (void)spi_num; (void)instruction_length; (void)address_length;
+    (void)wait_cycles; (void)instruction_address_trans_mode;
+}
+
+uint32_t spi_set_clk_rate(spi_device_num_t spi_num, uint32_t spi_clk) {
+    (void)spi_num;
+    mock_sdk.clkRate = spi_clk;
+    return spi_clk;
+}
+
+void spi_send_data_normal_dma(dmac_channel_number_t channel_num, spi_device_num_t spi_num,
+                              spi_chip_select_t chip_select, const void *tx_buff, size_t tx_len,
+                              spi_transfer_width_t spi_transfer_width) {
+    (void)channel_num; (void)spi_num; (void)chip_select;
+    mock_sdk.sends++;
+    mock_sdk.sentBytes += tx_len * spi_transfer_width;
+    if(spi_transfer_width != SPI_TRANS_INT) {
+        mock_sdk.copies++;
+    }
+
+    uint32_t mask = (mock_sdk.frameBits >= 32) ? 0xFFFFFFFF : ((1U << mock_sdk.frameBits) - 1);
+    for(size_t i = 0; i < tx_len; i++) {
+        uint32_t frame;
+        switch(spi_transfer_width) {
+            case SPI_TRANS_INT:   frame = ((const uint32_t *)tx_buff)[i]; break;
+            case SPI_TRANS_SHORT: frame = ((const uint16_t *)tx_buff)[i]; break;
+            case SPI_TRANS_CHAR:
+            default:              frame = ((const uint8_t  *)tx_buff)[i]; break;
+        }
+        if(mock_sdk.frameCount < MOCK_SPI_FRAMES) {
+            mock_sdk.frames[mock_sdk.frameCount]    = frame & mask;
+            mock_sdk.frameSize[mock_sdk.frameCount] = (uint8_t)mock_sdk.frameBits;
+        }
+        mock_sdk.frameCount++;
+    }
+}
+
+void spi_fill_data_dma(dmac_channel_number_t channel_num, spi_device_num_t spi_num, spi_chip_select_t chip_select,
+                       const uint32_t *tx_buff, size_t tx_len) {
+    (void)channel_num; (void)spi_num; (void)chip_select; (void)tx_buff; (void)tx_len;
+    mock_sdk.fills++;
+}
+
+void spi_receive_data_multiple(spi_device_num_t spi_num, spi_chip_select_t chip_select, const uint32_t *cmd_buff,
+                               size_t cmd_len, uint8_t *rx_buff, size_t rx_len) {
+    (void)spi_num; (void)chip_select; (void)cmd_buff; (void)cmd_len;
+    mock_sdk.reads++;
+    if(mock_sdk.rx) {
+        mock_sdk.rx(rx_buff, rx_len, mock_sdk.clkRate);
+    } else {
+        /* Nothing drives the bus */
+        memset(rx_buff, 0xFF, rx_len);
+    }
+}
+
+void gpiohs_set_drive_mode(uint8_t pin, gpio_drive_mode_t mode) {
+    (void)pin; (void)mode;
+}
+
+void gpiohs_set_pin(uint8_t pin, gpio_pin_value_t value) {
+    if(pin < MOCK_GPIOHS_PINS) {
+        mock_sdk.pins[pin] = value;
+    }
+}
+
+void uart_init(uart_device_number_t channel) {
+    (void)channel;
+}
+
+void uart_configure(uart_device_number_t channel, uint32_t baud_rate, uart_bitwidth_t data_width,
+                    uart_stopbit_t stopbit, uart_parity_t parity) {
+    (void)channel; (void)baud_rate; (void)data_width; (void)stopbit; (void)parity;
+}
+
+int uart_send_data(uart_device_number_t channel, const char *buffer, size_t buf_len) {
+    (void)channel;
+    for(size_t i = 0; i < buf_len; i++) {
+        if(mock_sdk.uartCount < MOCK_UART_BYTES) {
+            mock_sdk.uart[mock_sdk.uartCount] = (uint8_t)buffer[i];
+        }
+        mock_sdk.uartCount++;
+    }
+    return (int)buf_len;
+}
+
+int uart_receive_data(uart_device_number_t channel, char *buffer, size_t buf_len) {
+    (void)channel;
+    if(mock_sdk.uartCount < mock_sdk.uartInputAfter) {
+        return 0;
+    }
+
+    size_t n = 0;
+    while((n < buf_len) && (mock_sdk.uartInputPos < mock_sdk.uartInputCount)) {
+        buffer[n++] = (char)mock_sdk.uartInput[mock_sdk.uartInputPos++];
+    }
+    return (int)n;
+}
+
+void mock_uart_input(const char *data, size_t len, size_t after) {
+    if(len > MOCK_UART_INPUT) {
+        len = MOCK_UART_INPUT;
+    }
+    memcpy(mock_sdk.uartInput, data, len);
+    mock_sdk.uartInputCount = len;
+    mock_sdk.uartInputPos   = 0;
+    mock_sdk.uartInputAfter = after;
+}
+
+int usleep(uint64_t usec) {
+    mock_sdk.timeUs += usec;
+    return 0;
+}
+
+int msleep(uint64_t msec) {
+    return usleep(msec * 1000);
+}
+
+uint32_t sysctl_clock_get_freq(sysctl_clock_t clock) {
+    (void)clock;
+    return MOCK_CPU_FREQ;
+}
+
+uint64_t sysctl_get_time_us(void) {
+    /* Let polling loops make progress */
+    return mock_sdk.timeUs++;
+}
+
+uint64_t mock_read_cycle(void) {
+    return sysctl_get_time_us() * (MOCK_CPU_FREQ / 1000000);
+}
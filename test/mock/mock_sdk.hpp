@@ -0,0 +1,77 @@
+#ifndef MOCK_SDK_HPP
+#define MOCK_SDK_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <spi.h>
+#include <gpiohs.h>
+#include <uart.h>
+
+/**
+ * Minimal host implementation of the parts of the Kendryte SDK used by the
+ * drivers under test. Hardware state is recorded in mock_sdk so tests can
+ * inspect it, and SPI reads are answered by a replaceable callback.
+ */
+
+#define MOCK_GPIOHS_PINS 32
+#define MOCK_SPI_FRAMES  4096  /*!< Number of sent SPI frames recorded */
+#define MOCK_UART_BYTES  65536 /*!< Number of sent UART bytes recorded */
+#define MOCK_UART_INPUT  64    /*!< Maximum UART bytes queued for reception */
+
+/**
+ * SPI read handler. Frames sent before the read can be inspected in mock_sdk
+ * to decide what to return.
+ *
+ * @param rx   Where to store data read
+ * @param len  Number of bytes to read
+ * @param rate SPI clock rate in effect
+ */
+typedef void (*mock_spi_rx_t)(uint8_t *rx, size_t len, uint32_t rate);
+
+typedef struct {
+    uint32_t         clkRate;                 /*!< Last SPI clock rate set */
+    size_t           frameBits;               /*!< Frame size from last spi_init */
+    gpio_pin_value_t pins[MOCK_GPIOHS_PINS];  /*!< GPIOHS output values */
+
+    uint32_t         sends;                   /*!< Number of spi_send_data_normal_dma calls */
+    uint32_t         copies;                  /*!< spi_send_data_normal_dma calls the SDK would copy to a temporary buffer */
+    size_t           sentBytes;               /*!< Bytes of memory read by spi_send_data_normal_dma */
+
+    uint32_t         frames[MOCK_SPI_FRAMES]; /*!< Frames sent, truncated to frame size */
+    uint8_t          frameSize[MOCK_SPI_FRAMES]; /*!< Size of each frame sent, in bits */
+    size_t           frameCount;              /*!< Number of frames sent, may exceed MOCK_SPI_FRAMES */
+    uint32_t         fills;                   /*!< Number of spi_fill_data_dma calls */
+    uint32_t         reads;                   /*!< Number of spi_receive_data_multiple calls */
+
+    mock_spi_rx_t    rx;                      /*!< Read handler, NULL reads a floating bus */
+
+    uint8_t          uart[MOCK_UART_BYTES];   /*!< Bytes sent over UART */
+    size_t           uartCount;               /*!< Number of bytes sent over UART, may exceed MOCK_UART_BYTES */
+    uint8_t          uartInput[MOCK_UART_INPUT]; /*!< Bytes to be received over UART */
+    size_t           uartInputCount;          /*!< Number of bytes in uartInput */
+    size_t           uartInputPos;            /*!< Next byte of uartInput to receive */
+    size_t           uartInputAfter;          /*!< uartInput is only received once uartCount reaches this */
+
+    uint64_t         timeUs;                  /*!< Current time, advanced by every call to the clock */
+} mock_sdk_t;
+
+extern mock_sdk_t mock_sdk;
+
+/**
+ * Reset all recorded state.
+ */
+void mock_sdk_reset(void);
+
+/**
+ * Queue bytes to be received over UART, replacing any not yet received. They
+ * arrive once the given number of bytes have been sent, so input can be
+ * injected partway through a transmission.
+ *
+ * @param data  Bytes to receive
+ * @param len   Number of bytes, at most MOCK_UART_INPUT
+ * @param after Value of uartCount from which the bytes can be received
+ */
+void mock_uart_input(const char *data, size_t len, size_t after);
+
+#endif
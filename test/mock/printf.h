@@ -0,0 +1,10 @@
+#ifndef MOCK_PRINTF_H
+#define MOCK_PRINTF_H
+
+/* Host stand-in for the Kendryte SDK's printf.h, see mock_sdk.hpp */
+
+#include <assert.h>
+
+#define configASSERT(x) assert(x)
+
+#endif
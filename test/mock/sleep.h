@@ -0,0 +1,11 @@
+#ifndef MOCK_SLEEP_H
+#define MOCK_SLEEP_H
+
+/* Host stand-in for the Kendryte SDK's sleep.h, see mock_sdk.hpp */
+
+#include <stdint.h>
+
+int usleep(uint64_t usec);
+int msleep(uint64_t msec);
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef MOCK_SPI_H
+#define MOCK_SPI_H
+
+/* Host stand-in for the Kendryte SDK's spi.h, see mock_sdk.hpp */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <dmac.h>
+
+typedef enum {
+    SPI_DEVICE_0,
+    SPI_DEVICE_1,
+    SPI_DEVICE_2,
+    SPI_DEVICE_3,
+    SPI_DEVICE_MAX
+} spi_device_num_t;
+
+typedef enum {
+    SPI_WORK_MODE_0,
+    SPI_WORK_MODE_1,
+    SPI_WORK_MODE_2,
+    SPI_WORK_MODE_3
+} spi_work_mode_t;
+
+typedef enum {
+    SPI_FF_STANDARD,
+    SPI_FF_DUAL,
+    SPI_FF_QUAD,
+    SPI_FF_OCTAL
+} spi_frame_format_t;
+
+typedef enum {
+    SPI_AITM_STANDARD,
+    SPI_AITM_ADDR_STANDARD,
+    SPI_AITM_AS_FRAME_FORMAT
+} spi_instruction_address_trans_mode_t;
+
+typedef enum {
+    SPI_CHIP_SELECT_0,
+    SPI_CHIP_SELECT_1,
+    SPI_CHIP_SELECT_2,
+    SPI_CHIP_SELECT_3,
+    SPI_CHIP_SELECT_MAX
+} spi_chip_select_t;
+
+typedef enum {
+    SPI_TRANS_CHAR  = 0x1,
+    SPI_TRANS_SHORT = 0x2,
+    SPI_TRANS_INT   = 0x4
+} spi_transfer_width_t;
+
+void spi_init(spi_device_num_t spi_num, spi_work_mode_t work_mode, spi_frame_format_t frame_format,
+              size_t data_bit_length, uint32_t endian);
+void spi_init_non_standard(spi_device_num_t spi_num, uint32_t instruction_length, uint32_t address_length,
+                           uint32_t wait_cycles, spi_instruction_address_trans_mode_t instruction_address_trans_mode);
+uint32_t spi_set_clk_rate(spi_device_num_t spi_num, uint32_t spi_clk);
+void spi_send_data_normal_dma(dmac_channel_number_t channel_num, spi_device_num_t spi_num,
+                              spi_chip_select_t chip_select, const void *tx_buff, size_t tx_len,
+                              spi_transfer_width_t spi_transfer_width);
+void spi_fill_data_dma(dmac_channel_number_t channel_num, spi_device_num_t spi_num, spi_chip_select_t chip_select,
+                       const uint32_t *tx_buff, size_t tx_len);
+void spi_receive_data_multiple(spi_device_num_t spi_num, spi_chip_select_t chip_select, const uint32_t *cmd_buff,
+                               size_t cmd_len, uint8_t *rx_buff, size_t rx_len);
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef MOCK_SYSCTL_H
+#define MOCK_SYSCTL_H
+
+/* Host stand-in for the Kendryte SDK's sysctl.h, see mock_sdk.hpp */
+
+#include <stdint.h>
+
+typedef enum {
+    SYSCTL_CLOCK_CPU,
+    SYSCTL_CLOCK_SPI0
+} sysctl_clock_t;
+
+uint32_t sysctl_clock_get_freq(sysctl_clock_t clock);
+uint64_t sysctl_get_time_us(void);
+
+#endif
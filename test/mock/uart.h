@@ -0,0 +1,41 @@
+#ifndef MOCK_UART_H
+#define MOCK_UART_H
+
+/* Host stand-in for the Kendryte SDK's uart.h, see mock_sdk.hpp */
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    UART_DEVICE_1,
+    UART_DEVICE_2,
+    UART_DEVICE_3,
+    UART_DEVICE_MAX
+} uart_device_number_t;
+
+typedef enum {
+    UART_BITWIDTH_5BIT = 5,
+    UART_BITWIDTH_6BIT,
+    UART_BITWIDTH_7BIT,
+    UART_BITWIDTH_8BIT
+} uart_bitwidth_t;
+
+typedef enum {
+    UART_STOP_1,
+    UART_STOP_1_5,
+    UART_STOP_2
+} uart_stopbit_t;
+
+typedef enum {
+    UART_PARITY_NONE,
+    UART_PARITY_ODD,
+    UART_PARITY_EVEN
+} uart_parity_t;
+
+void uart_init(uart_device_number_t channel);
+void uart_configure(uart_device_number_t channel, uint32_t baud_rate, uart_bitwidth_t data_width,
+                    uart_stopbit_t stopbit, uart_parity_t parity);
+int uart_send_data(uart_device_number_t channel, const char *buffer, size_t buf_len);
+int uart_receive_data(uart_device_number_t channel, char *buffer, size_t buf_len);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef TEST_HPP
+#define TEST_HPP
+
+#include <stdio.h>
+
+/**
+ * Minimal assertion helpers for host tests. Failed expectations are printed
+ * and counted, and test_result() gives the process exit code for ctest.
+ */
+
+static int test_checks   = 0;
+static int test_failures = 0;
+
+#define TEST_EXPECT(cond) test_expect((cond), #cond, __FILE__, __LINE__)
+
+static inline bool test_expect(bool ok, const char *cond, const char *file, int line) {
+    test_checks++;
+    if(!ok) {
+        test_failures++;
+        printf("%s:%d: expected %s\n", file, line, cond);
+    }
+    return ok;
+}
+
+static inline int test_result(void) {
+    printf("%d/%d checks passed\n", test_checks - test_failures, test_checks);
+    return test_failures ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,101 @@
+#include <stdio.h>
+
+#include <NT35310.hpp>
+
+#include "mock/mock_sdk.hpp"
+#include "test.hpp"
+
+#define PANEL_WIDTH  240
+#define PANEL_HEIGHT 320
+
+/**
+ * Model of how the controller maps memory addresses to the panel. Column and
+ * page addresses are exchanged first if MV is set, then MX and MY flip the
+ * panel axes. The panel's native column order is right-to-left, so MX gives
+ * left-to-right.
+ *
+ * @param mode SET_ADDRESS_MODE value
+ * @param col  Column address written
+ * @param page Page address written
+ * @param px   Resulting panel column, from the left
+ * @param py   Resulting panel row, from the top
+ */
+static void model(uint8_t mode, uint16_t col, uint16_t page, uint16_t *px, uint16_t *py) {
+    uint16_t a = (mode & NT35310_ADDR_MODE_MV) ? page : col;
+    uint16_t b = (mode & NT35310_ADDR_MODE_MV) ? col  : page;
+
+    *px = (mode & NT35310_ADDR_MODE_MX) ? a : (uint16_t)(PANEL_WIDTH - 1 - a);
+    *py = (mode & NT35310_ADDR_MODE_MY) ? (uint16_t)(PANEL_HEIGHT - 1 - b) : b;
+}
+
+/**
+ * Where a logical pixel should end up on the panel, for a display rotated
+ * clockwise by the given amount and optionally mirrored left-to-right.
+ */
+static void expected(nt35310_rotation_e rotation, bool mirror, uint16_t w, uint16_t x, uint16_t y,
+                     uint16_t *px, uint16_t *py) {
+    if(mirror) {
+        x = (uint16_t)(w - 1 - x);
+    }
+
+    switch(rotation) {
+        case NT35310_ROTATION_90:
+            *px = (uint16_t)(PANEL_WIDTH - 1 - y);
+            *py = x;
+            break;
+        case NT35310_ROTATION_180:
+            *px = (uint16_t)(PANEL_WIDTH  - 1 - x);
+            *py = (uint16_t)(PANEL_HEIGHT - 1 - y);
+            break;
+        case NT35310_ROTATION_270:
+            *px = y;
+            *py = (uint16_t)(PANEL_HEIGHT - 1 - x);
+            break;
+        case NT35310_ROTATION_0:
+        default:
+            *px = x;
+            *py = y;
+            break;
+    }
+}
+
+int main(void) {
+    static const nt35310_rotation_e rotations[] = {
+        NT35310_ROTATION_0, NT35310_ROTATION_90, NT35310_ROTATION_180, NT35310_ROTATION_270
+    };
+
+    mock_sdk_reset();
+    NT35310 lcd(SPI_DEVICE_0, SPI_CHIP_SELECT_0, 0, 1, PANEL_WIDTH, PANEL_HEIGHT);
+
+    for(nt35310_rotation_e rotation : rotations) {
+        for(int mirror = 0; mirror < 2; mirror++) {
+            uint8_t mode = NT35310::addressMode(rotation, mirror);
+            printf("rotation %d, mirror %d: mode 0x%02X\n", (int)rotation * 90, mirror, mode);
+
+            /* Only orientation bits may be touched */
+            TEST_EXPECT(!(mode & ~(NT35310_ADDR_MODE_MY | NT35310_ADDR_MODE_MX | NT35310_ADDR_MODE_MV)));
+
+            lcd.setOrientation(rotation, mirror);
+            uint16_t w = lcd.getWidth();
+            uint16_t h = lcd.getHeight();
+            bool landscape = (rotation == NT35310_ROTATION_90) || (rotation == NT35310_ROTATION_270);
+            TEST_EXPECT(w == (landscape ? PANEL_HEIGHT : PANEL_WIDTH));
+            TEST_EXPECT(h == (landscape ? PANEL_WIDTH  : PANEL_HEIGHT));
+
+            unsigned mismatches = 0;
+            for(uint16_t y = 0; y < h; y++) {
+                for(uint16_t x = 0; x < w; x++) {
+                    uint16_t mx, my, ex, ey;
+                    model(mode, x, y, &mx, &my);
+                    expected(rotation, mirror, w, x, y, &ex, &ey);
+                    if((mx != ex) || (my != ey)) {
+                        mismatches++;
+                    }
+                }
+            }
+            TEST_EXPECT(mismatches == 0);
+        }
+    }
+
+    return test_result();
+}
@@ -0,0 +1,76 @@
+#include <stdio.h>
+
+#include <NT35310.hpp>
+
+#include "mock/mock_sdk.hpp"
+#include "test.hpp"
+
+#define SRC_STRIDE 13
+#define SRC_HEIGHT 7
+
+alignas(NT35310_BUFFER_ALIGN) static nt35310_pixel_t src[((SRC_STRIDE * SRC_HEIGHT) + 1) & ~1];
+
+/**
+ * Check that a blit sends exactly the pixels of the rectangle, in order, and
+ * that none of the pixel data goes through the SDK's copying path.
+ */
+static void check_blit(NT35310 &lcd, uint16_t sx, uint16_t sy, uint16_t w, uint16_t h) {
+    mock_sdk_reset();
+    lcd.blit(src, SRC_STRIDE, sx, sy, w, h, 0, 0);
+
+    /* Pixel data follows the last command byte */
+    size_t first = mock_sdk.frameCount;
+    while((first > 0) && (mock_sdk.frameSize[first - 1] != 8)) {
+        first--;
+    }
+
+    size_t   n  = 0;
+    bool     ok = true;
+    for(size_t i = first; i < mock_sdk.frameCount; i++) {
+        nt35310_pixel_t px[2];
+        size_t          count = 0;
+        if(mock_sdk.frameSize[i] == 32) {
+            /* Upper half is shifted out first */
+            px[count++] = (nt35310_pixel_t)(mock_sdk.frames[i] >> 16);
+            px[count++] = (nt35310_pixel_t)mock_sdk.frames[i];
+        } else {
+            px[count++] = (nt35310_pixel_t)mock_sdk.frames[i];
+        }
+
+        for(size_t j = 0; j < count; j++, n++) {
+            uint16_t x = (uint16_t)(sx + (n % w));
+            uint16_t y = (uint16_t)(sy + (n / w));
+            ok = ok && (px[j] == (nt35310_pixel_t)((y * SRC_STRIDE) + x + 1));
+        }
+    }
+
+    printf("blit %2ux%-2u from (%2u,%u): %zu pixels in %u transfers\n",
+           w, h, sx, sy, n, mock_sdk.sends);
+    TEST_EXPECT(ok);
+    TEST_EXPECT(n == ((size_t)w * h));
+    /* Only the command and area setup may be copied by the SDK */
+    TEST_EXPECT(mock_sdk.copies == 5);
+}
+
+int main(void) {
+    for(size_t i = 0; i < (SRC_STRIDE * SRC_HEIGHT); i++) {
+        src[NT35310_PIXEL_INDEX(i)] = (nt35310_pixel_t)(i + 1);
+    }
+
+    mock_sdk_reset();
+    NT35310 lcd(SPI_DEVICE_0, SPI_CHIP_SELECT_0, 0, 1, 240, 320);
+
+    /* Whole image as a single run, odd total length */
+    check_blit(lcd, 0, 0, SRC_STRIDE, SRC_HEIGHT);
+    /* Whole image, even total length */
+    check_blit(lcd, 0, 1, SRC_STRIDE, 6);
+
+    /* Every start alignment and width parity, row by row */
+    for(uint16_t sx = 0; sx < 4; sx++) {
+        for(uint16_t w = 1; w <= 6; w++) {
+            check_blit(lcd, sx, 1, w, 3);
+        }
+    }
+
+    return test_result();
+}
@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <NT35310.hpp>
+
+#include "mock/mock_sdk.hpp"
+#include "test.hpp"
+
+#define DC_PIN       1
+#define DISPLAY_ID   0x015310 /*!< ID returned by the emulated controller */
+#define MAX_GOOD_CLK 20000000 /*!< Fastest rate the emulated controller reads back correctly at */
+
+static const uint32_t tiers[] = NT35310_CLK_RATE_TIERS;
+#define TIER_COUNT (sizeof(tiers) / sizeof(tiers[0]))
+
+/* Mock probe, passes at or below a limit and records the rates tried */
+static uint32_t probeLimit;
+static uint32_t probeTried[TIER_COUNT];
+static size_t   probeCount;
+
+static bool probe(void *ctx, uint32_t rate) {
+    (void)ctx;
+    if(probeCount < TIER_COUNT) {
+        probeTried[probeCount] = rate;
+    }
+    probeCount++;
+    return (rate <= probeLimit);
+}
+
+static uint32_t select_rate(uint32_t limit) {
+    probeLimit = limit;
+    probeCount = 0;
+    return NT35310::selectClockRate(tiers, TIER_COUNT, NT35310_CLK_RATE_DEFAULT, &probe, NULL);
+}
+
+/* Whether every read so far happened with DC high */
+static bool readDCHigh;
+
+/**
+ * Emulates read data from a controller with the RD line connected. The
+ * command is the last 8-bit frame sent, GRAM reads return the pixels of the
+ * last pixel write. Reads above MAX_GOOD_CLK are corrupted.
+ */
+static void controller_rx(uint8_t *rx, size_t len, uint32_t rate) {
+    readDCHigh = readDCHigh && (mock_sdk.pins[DC_PIN] == GPIO_PV_HIGH);
+
+    size_t end = mock_sdk.frameCount;
+    uint8_t cmd = (end > 0) ? (uint8_t)mock_sdk.frames[end - 1] : 0;
+
+    memset(rx, 0, len);
+    if(cmd == NT35310_CMD_READ_DISPLAY_ID) {
+        if(len >= 4) {
+            rx[1] = (uint8_t)(DISPLAY_ID >> 16);
+            rx[2] = (uint8_t)(DISPLAY_ID >> 8);
+            rx[3] = (uint8_t)DISPLAY_ID;
+        }
+    } else if(cmd == NT35310_CMD_READ_MEMORY_START) {
+        /* Find the last run of pixel frames, before the area setup */
+        while((end > 0) && (mock_sdk.frameSize[end - 1] == 8)) {
+            end--;
+        }
+        size_t first = end;
+        while((first > 0) && (mock_sdk.frameSize[first - 1] != 8)) {
+            first--;
+        }
+
+        size_t pos = 1; /* First byte is a dummy read */
+        for(size_t i = first; (i < end) && (pos < len); i++) {
+            uint16_t px[2];
+            size_t   count = 0;
+            if(mock_sdk.frameSize[i] == 32) {
+                px[count++] = (uint16_t)(mock_sdk.frames[i] >> 16);
+            }
+            px[count++] = (uint16_t)mock_sdk.frames[i];
+
+            for(size_t j = 0; (j < count) && ((pos + 3) <= len); j++) {
+                rx[pos++] = (uint8_t)((px[j] >> 8) & 0xF8);
+                rx[pos++] = (uint8_t)((px[j] >> 3) & 0xFC);
+                rx[pos++] = (uint8_t)((px[j] << 3) & 0xF8);
+            }
+        }
+    }
+
+    if(rate > MAX_GOOD_CLK) {
+        rx[len - 1] ^= 0x80;
+    }
+
+    /* Only frames since the last read matter */
+    mock_sdk.frameCount = 0;
+}
+
+int main(void) {
+    /* Fastest passing tier is picked, trying fastest first */
+    TEST_EXPECT(select_rate(0xFFFFFFFF) == tiers[0]);
+    TEST_EXPECT(probeCount == 1);
+
+    TEST_EXPECT(select_rate(20000000) == 20000000);
+    TEST_EXPECT(probeCount == 3);
+    TEST_EXPECT((probeTried[0] == tiers[0]) && (probeTried[1] == tiers[1]) && (probeTried[2] == tiers[2]));
+
+    /* Between tiers, the next slower one is picked */
+    TEST_EXPECT(select_rate(12000000) == 10000000);
+
+    /* Nothing passes */
+    TEST_EXPECT(select_rate(0) == NT35310_CLK_RATE_DEFAULT);
+    TEST_EXPECT(probeCount == TIER_COUNT);
+
+    /* No tiers */
+    probeCount = 0;
+    TEST_EXPECT(NT35310::selectClockRate(tiers, 0, 1234, &probe, NULL) == 1234);
+    TEST_EXPECT(probeCount == 0);
+
+    /* Floating bus, as on a board without the RD line */
+    mock_sdk_reset();
+    NT35310 lcd(SPI_DEVICE_0, SPI_CHIP_SELECT_0, 0, DC_PIN, 240, 320);
+    lcd.setClockRate(15000000);
+    TEST_EXPECT(!lcd.readbackAvailable());
+    TEST_EXPECT(mock_sdk.clkRate == 15000000);
+    TEST_EXPECT(lcd.autoClockRate() == NT35310_CLK_RATE_DEFAULT);
+
+    /* Emulated controller, readback works up to MAX_GOOD_CLK */
+    mock_sdk_reset();
+    mock_sdk.rx = controller_rx;
+    readDCHigh  = true;
+    TEST_EXPECT(lcd.readbackAvailable());
+    uint32_t rate = lcd.autoClockRate();
+    printf("Emulated controller: selected %u Hz after %u reads\n", rate, mock_sdk.reads);
+    TEST_EXPECT(rate == MAX_GOOD_CLK);
+    TEST_EXPECT(mock_sdk.clkRate == MAX_GOOD_CLK);
+    TEST_EXPECT(readDCHigh);
+
+    return test_result();
+}
@@ -0,0 +1,101 @@
+#include <math.h>
+#include <stdio.h>
+
+#include <fixlog.hpp>
+#include <DerivedValue.hpp>
+
+#include "test.hpp"
+
+#define LOG2_ERROR  2.5e-5 /*!< Maximum absolute error of fixlog_log2, in log2 units */
+#define EXP2_ERROR  2.5e-5 /*!< Maximum relative error of fixlog_exp2 */
+#define DERIVED_TOL 1e-3   /*!< Tolerance for derived values, dominated by fixlog and Q16.16 rounding */
+
+static bool near(float a, double b, double tol) {
+    return fabs((double)a - b) <= tol;
+}
+
+int main(void) {
+    /* log2 across many octaves, including non-table-aligned mantissas */
+    double worst = 0;
+    for(double x = 1e-6; x < 1e6; x *= 1.0001) {
+        int32_t l   = fixlog_log2((float)x);
+        double  err = fabs(((double)l / FIXLOG_ONE) - log2((double)(float)x));
+        if(err > worst) {
+            worst = err;
+        }
+    }
+    printf("fixlog_log2: worst error %.3g\n", worst);
+    TEST_EXPECT(worst <= LOG2_ERROR);
+
+    TEST_EXPECT(fixlog_log2(0.0f)  == FIXLOG_INVALID);
+    TEST_EXPECT(fixlog_log2(-1.0f) == FIXLOG_INVALID);
+    TEST_EXPECT(fixlog_log2(1.0f)  == 0);
+    TEST_EXPECT(fixlog_log2(8.0f)  == 3 * FIXLOG_ONE);
+
+    /* exp2 of every Q16.16 step over a range of exponents */
+    worst = 0;
+    for(int32_t q = -20 * FIXLOG_ONE; q < 20 * FIXLOG_ONE; q += 7) {
+        double exact = exp2((double)q / FIXLOG_ONE);
+        double err   = fabs(((double)fixlog_exp2(q) - exact) / exact);
+        if(err > worst) {
+            worst = err;
+        }
+    }
+    printf("fixlog_exp2: worst relative error %.3g\n", worst);
+    TEST_EXPECT(worst <= EXP2_ERROR);
+
+    DerivedValue    d;
+    derived_value_t v;
+
+    /* Not relative: only the level is available */
+    d.update(0.7746f, NAN, false);
+    d.get(&v);
+    TEST_EXPECT(isnan(v.delta) && isnan(v.percent) && isnan(v.dbRel));
+    TEST_EXPECT(near(v.level, 20 * log10(0.7746 / sqrt(0.6)), DERIVED_TOL));
+
+    /* Relative 1.0, displaying 0.5: absolute reading is 1.5 */
+    d.update(0.5f, 1.0f, false);
+    d.get(&v);
+    TEST_EXPECT(near(v.delta,   0.5, DERIVED_TOL));
+    TEST_EXPECT(near(v.percent, 50.0, DERIVED_TOL));
+    TEST_EXPECT(near(v.dbRel,   20 * log10(1.5), DERIVED_TOL));
+    TEST_EXPECT(near(v.level,   20 * log10(1.5 / sqrt(0.6)), DERIVED_TOL));
+
+    /* Negative relative value, displayed deviation of -1.0 from -2.0 */
+    d.update(-1.0f, -2.0f, false);
+    d.get(&v);
+    TEST_EXPECT(near(v.delta,   -1.0, DERIVED_TOL));
+    TEST_EXPECT(near(v.percent, 50.0, DERIVED_TOL));
+    TEST_EXPECT(near(v.dbRel,   20 * log10(3.0 / 2.0), DERIVED_TOL));
+
+    /* Absolute reading of 0 has no logarithm */
+    d.update(-1.0f, 1.0f, false);
+    d.get(&v);
+    TEST_EXPECT(near(v.percent, -100.0, DERIVED_TOL));
+    TEST_EXPECT(isnan(v.dbRel) && isnan(v.level));
+
+    /* Relative 0 has no percentage or ratio */
+    d.update(1.0f, 0.0f, false);
+    d.get(&v);
+    TEST_EXPECT(near(v.delta, 1.0, DERIVED_TOL));
+    TEST_EXPECT(isnan(v.percent) && isnan(v.dbRel));
+
+    /* dB: level is the voltage of the reading */
+    d.update(6.0f, NAN, true);
+    d.get(&v);
+    TEST_EXPECT(near(v.level, sqrt(0.6) * pow(10, 6.0 / 20), DERIVED_TOL));
+
+    /* dB relative: displayed value is already the ratio, absolute is the sum */
+    d.update(-3.0f, 4.0f, true);
+    d.get(&v);
+    TEST_EXPECT(near(v.dbRel, -3.0, DERIVED_TOL));
+    TEST_EXPECT(near(v.level, sqrt(0.6) * pow(10, 1.0 / 20), DERIVED_TOL));
+
+    /* Impedance changes the dBm reference */
+    d.setImpedance(50.0f);
+    d.update(sqrtf(0.05f), NAN, false);
+    d.get(&v);
+    TEST_EXPECT(near(v.level, 0.0, DERIVED_TOL));
+
+    return test_result();
+}
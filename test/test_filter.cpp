@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <Filter.hpp>
+
+#include "test.hpp"
+
+/* Reference median, by sorting a copy of the window */
+static int32_t reference_median(const int32_t *samples, size_t count) {
+    int32_t sorted[8];
+    for(size_t i = 0; i < count; i++) {
+        size_t j = i;
+        for(; (j > 0) && (sorted[j - 1] > samples[i]); j--) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = samples[i];
+    }
+    return sorted[count / 2];
+}
+
+static void test_median(void) {
+    FilterMedian<5> median;
+
+    TEST_EXPECT(median.process(10) == 10);
+    TEST_EXPECT(median.process(30) == 30); /* Upper of two */
+    TEST_EXPECT(median.process(20) == 20);
+    TEST_EXPECT(median.process(1000) == 30);
+    TEST_EXPECT(median.process(-5) == 20);
+
+    /* Full window, with duplicates and outliers, against a reference */
+    int32_t samples[256];
+    bool    ok = true;
+    srand(1);
+    for(size_t i = 0; i < 256; i++) {
+        samples[i] = (rand() % 16) - 8;
+        if(!(i % 17)) {
+            samples[i] *= 1000;
+        }
+        int32_t out = median.process(samples[i]);
+        if(i >= 4) {
+            ok &= (out == reference_median(&samples[i - 4], 5));
+        }
+    }
+    TEST_EXPECT(ok);
+
+    median.reset();
+    TEST_EXPECT(median.process(7) == 7);
+}
+
+static void test_moving_average(void) {
+    FilterMovingAverage<4> avg;
+
+    TEST_EXPECT(avg.process(4)  == 4);
+    TEST_EXPECT(avg.process(8)  == 6);  /* Averages over samples seen so far */
+    TEST_EXPECT(avg.process(12) == 8);
+    TEST_EXPECT(avg.process(16) == 10);
+    TEST_EXPECT(avg.process(20) == 14); /* 4 drops out */
+    TEST_EXPECT(avg.process(-60) == -3);
+
+    avg.reset();
+    TEST_EXPECT(avg.process(100) == 100);
+}
+
+static void test_exponential(void) {
+    FilterExponential<2> exp;
+
+    TEST_EXPECT(exp.process(1000) == 1000); /* Primed by first sample */
+    TEST_EXPECT(exp.process(0) == 750);
+    TEST_EXPECT(exp.process(0) == 562);
+
+    /* Converges on a constant input */
+    int32_t out = 0;
+    for(int i = 0; i < 100; i++) {
+        out = exp.process(-400);
+    }
+    TEST_EXPECT(out == -400);
+
+    exp.reset();
+    TEST_EXPECT(exp.process(5) == 5);
+}
+
+static void test_settle(void) {
+    FilterSettle<3, 2> settle;
+
+    TEST_EXPECT(settle.process(0) == 0); /* Passed through */
+    TEST_EXPECT(!settle.isSettled());
+    settle.process(1);
+    TEST_EXPECT(!settle.isSettled());   /* Window not yet full */
+    settle.process(2);
+    TEST_EXPECT(settle.isSettled());    /* 0,1,2 */
+    settle.process(3);
+    TEST_EXPECT(settle.isSettled());    /* 1,2,3 */
+    settle.process(10);
+    TEST_EXPECT(!settle.isSettled());
+
+    /* 0,2,3: [2,3] is within tolerance, so one more close sample settles */
+    settle.reset();
+    settle.process(0);
+    settle.process(2);
+    settle.process(3);
+    TEST_EXPECT(!settle.isSettled());
+    settle.process(2);
+    TEST_EXPECT(settle.isSettled());    /* 2,3,2 */
+
+    /* Single outlier keeps it unsettled until it leaves the window */
+    settle.process(9);
+    settle.process(2);
+    TEST_EXPECT(!settle.isSettled());
+    settle.process(2);
+    TEST_EXPECT(!settle.isSettled());
+    settle.process(2);
+    TEST_EXPECT(settle.isSettled());
+
+    settle.reset();
+    TEST_EXPECT(!settle.isSettled());
+}
+
+static void test_chain(void) {
+    FilterChain<FilterExponential<1>, FilterSettle<2, 0>> chain;
+
+    TEST_EXPECT(chain.getEnabled() == 0x3);
+    chain.process(100);
+    TEST_EXPECT(chain.process(0) == 50);
+    TEST_EXPECT(!chain.stage<1>().isSettled());
+
+    /* Bypassed stages pass samples through */
+    chain.setEnabled(0x2);
+    TEST_EXPECT(chain.getEnabled() == 0x2);
+    TEST_EXPECT(chain.process(40) == 40);
+    TEST_EXPECT(chain.process(40) == 40);
+    TEST_EXPECT(chain.stage<1>().isSettled());
+
+    /* Enabling a stage starts it from a clean state */
+    chain.setEnabled(0x3);
+    TEST_EXPECT(chain.process(8) == 8);
+    TEST_EXPECT(!chain.stage<1>().isSettled());
+
+    chain.setEnabled(0);
+    TEST_EXPECT(chain.process(-3) == -3);
+
+    chain.setEnabled(0x3);
+    chain.process(10);
+    chain.reset();
+    TEST_EXPECT(chain.process(20) == 20);
+}
+
+int main(void) {
+    test_median();
+    test_moving_average();
+    test_exponential();
+    test_settle();
+    test_chain();
+
+    return test_result();
+}
@@ -0,0 +1,306 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <DisplayMirror.hpp>
+
+#include "mock/mock_sdk.hpp"
+#include "test.hpp"
+
+#define WIDTH      64
+#define HEIGHT     64
+#define BPP        4
+#define ROW_BYTES  ((WIDTH * BPP) / 8)
+#define TILE_BYTES ((DISPLAYMIRROR_TILE * BPP) / 8)
+#define TILES_X    (WIDTH  / DISPLAYMIRROR_TILE)
+#define TILES_Y    (HEIGHT / DISPLAYMIRROR_TILE)
+#define TILES      (TILES_X * TILES_Y)
+#define UNLIMITED  (1 << 16) /*!< Budget large enough for a full screen */
+
+static uint8_t         pixels[ROW_BYTES * HEIGHT];
+static uint8_t         shadow[ROW_BYTES * HEIGHT];
+static nt35310_pixel_t palette[1 << BPP];
+
+/**
+ * Host side of the mirror, as tools/mirror.py keeps it.
+ */
+typedef struct {
+    uint8_t  pixels[ROW_BYTES * HEIGHT]; /*!< Host copy of the framebuffer */
+    bool     tiles[TILES];               /*!< Set for each tile a TILE frame was received for */
+    unsigned tileCount;                  /*!< Number of TILE frames received */
+    unsigned infos;                      /*!< Number of INFO frames received */
+    unsigned ends;                       /*!< Number of END frames received */
+} host_t;
+
+static host_t host;
+
+static void host_clear_counts(void) {
+    memset(host.tiles, 0, sizeof(host.tiles));
+    host.tileCount = 0;
+    host.infos     = 0;
+    host.ends      = 0;
+}
+
+/**
+ * Decode a TILE payload into the host copy.
+ *
+ * @return true if the payload was well formed
+ */
+static bool host_tile(const uint8_t *payload, uint16_t len) {
+    if(len < 4) {
+        return false;
+    }
+    uint16_t tx = (uint16_t)(payload[0] | (payload[1] << 8));
+    uint16_t ty = (uint16_t)(payload[2] | (payload[3] << 8));
+    if((tx >= TILES_X) || (ty >= TILES_Y)) {
+        return false;
+    }
+
+    /* PackBits */
+    uint8_t delta[TILE_BYTES * DISPLAYMIRROR_TILE];
+    size_t  out = 0;
+    for(uint16_t i = 4; i < len;) {
+        uint8_t n = payload[i++];
+        if(n < 128) {
+            if(((out + n + 1) > sizeof(delta)) || ((i + n + 1u) > len)) {
+                return false;
+            }
+            memcpy(&delta[out], &payload[i], n + 1);
+            out += n + 1;
+            i   += n + 1;
+        } else if(n > 128) {
+            if(((out + (257 - n)) > sizeof(delta)) || (i >= len)) {
+                return false;
+            }
+            memset(&delta[out], payload[i++], 257 - n);
+            out += 257 - n;
+        }
+    }
+    if(out != sizeof(delta)) {
+        return false;
+    }
+
+    for(uint16_t r = 0; r < DISPLAYMIRROR_TILE; r++) {
+        for(uint16_t c = 0; c < TILE_BYTES; c++) {
+            size_t off = ((size_t)((ty * DISPLAYMIRROR_TILE) + r) * ROW_BYTES) + (tx * TILE_BYTES) + c;
+            host.pixels[off] ^= delta[(r * TILE_BYTES) + c];
+        }
+    }
+    host.tiles[(ty * TILES_X) + tx] = true;
+    host.tileCount++;
+    return true;
+}
+
+/**
+ * Receive frames sent since the given UART offset.
+ *
+ * @param from Offset of first byte to parse
+ *
+ * @return true if all frames were well formed
+ */
+static bool host_receive(size_t from) {
+    const uint8_t *b = mock_sdk.uart;
+    size_t         i = from;
+    while(i < mock_sdk.uartCount) {
+        if(((mock_sdk.uartCount - i) < 6) ||
+           (b[i] != DISPLAYMIRROR_SYNC0) || (b[i + 1] != DISPLAYMIRROR_SYNC1)) {
+            return false;
+        }
+        uint8_t  type = b[i + 2];
+        uint16_t len  = (uint16_t)(b[i + 3] | (b[i + 4] << 8));
+        uint8_t  sum  = b[i + 2] ^ b[i + 3] ^ b[i + 4];
+        if((i + 6 + len) > mock_sdk.uartCount) {
+            return false;
+        }
+        for(uint16_t j = 0; j < len; j++) {
+            sum ^= b[i + 5 + j];
+        }
+        if(sum != b[i + 5 + len]) {
+            return false;
+        }
+
+        const uint8_t *payload = &b[i + 5];
+        switch(type) {
+            case DISPLAYMIRROR_FRAME_INFO:
+                memset(host.pixels, 0, sizeof(host.pixels));
+                host.infos++;
+                break;
+            case DISPLAYMIRROR_FRAME_TILE:
+                if(!host_tile(payload, len)) {
+                    return false;
+                }
+                break;
+            case DISPLAYMIRROR_FRAME_END:
+                host.ends++;
+                break;
+            default:
+                break;
+        }
+        i += 6 + len;
+    }
+    return true;
+}
+
+/**
+ * Run an update, passing everything sent to the host.
+ */
+static void update(DisplayMirror &mirror, size_t budget) {
+    size_t from = mock_sdk.uartCount;
+    mirror.update(pixels, palette, budget);
+    TEST_EXPECT(host_receive(from));
+}
+
+/**
+ * Change every tile, so a full scan has something to send for each.
+ */
+static void change_all(uint8_t seed) {
+    for(size_t i = 0; i < sizeof(pixels); i++) {
+        pixels[i] = (uint8_t)((i * 7) + seed);
+    }
+}
+
+static void test_round_robin(DisplayMirror &mirror) {
+    /* Bottom-right tile changes once, top-left tile changes on every update.
+     * With a budget of one tile per update, the bottom-right tile must still
+     * get through. */
+    pixels[sizeof(pixels) - 1] = 0x12;
+    host_clear_counts();
+    unsigned updates = 0;
+    while(!host.tiles[TILES - 1] && (updates < (2 * TILES))) {
+        pixels[0] ^= 0x11;
+        update(mirror, 1);
+        updates++;
+    }
+    printf("Starved tile sent after %u updates\n", updates);
+    TEST_EXPECT(host.tiles[TILES - 1]);
+    TEST_EXPECT(updates <= 2);
+
+    /* Once caught up, a full scan completes and ends the frame */
+    host_clear_counts();
+    update(mirror, UNLIMITED);
+    update(mirror, UNLIMITED);
+    TEST_EXPECT(host.ends >= 1);
+    TEST_EXPECT(memcmp(pixels, shadow, sizeof(pixels)) == 0);
+    TEST_EXPECT(memcmp(pixels, host.pixels, sizeof(pixels)) == 0);
+}
+
+static void test_end_pending(DisplayMirror &mirror) {
+    /* Only the last tile changes, and sending it uses up the budget. The
+     * END owed for it must follow on a later update, even though nothing
+     * else changes. */
+    pixels[sizeof(pixels) - 1] ^= 0x34;
+    host_clear_counts();
+    update(mirror, 1);
+    TEST_EXPECT(host.tileCount == 1);
+    TEST_EXPECT(host.ends == 0);
+
+    for(int i = 0; i < 5; i++) {
+        update(mirror, UNLIMITED);
+    }
+    TEST_EXPECT(host.tileCount == 1);
+    TEST_EXPECT(host.ends == 1);
+    TEST_EXPECT(memcmp(pixels, host.pixels, sizeof(pixels)) == 0);
+
+    /* Full-screen change at one tile per update: END only once all tiles
+     * have been sent */
+    change_all(4);
+    host_clear_counts();
+    unsigned updates = 0;
+    while(!host.ends && (updates < (2 * TILES))) {
+        update(mirror, 1);
+        updates++;
+    }
+    TEST_EXPECT(host.tileCount == TILES);
+    TEST_EXPECT(host.ends == 1);
+    TEST_EXPECT(memcmp(pixels, host.pixels, sizeof(pixels)) == 0);
+
+    /* Nothing owed, nothing sent */
+    size_t before = mock_sdk.uartCount;
+    mirror.update(pixels, palette, UNLIMITED);
+    TEST_EXPECT(mock_sdk.uartCount == before);
+}
+
+static void test_keyframe(DisplayMirror &mirror) {
+    /* Keyframe while idle resends the whole screen */
+    mock_uart_input("K", 1, mock_sdk.uartCount);
+    host_clear_counts();
+    update(mirror, UNLIMITED);
+    TEST_EXPECT(host.infos == 1);
+    TEST_EXPECT(host.ends == 1);
+    TEST_EXPECT(memcmp(pixels, host.pixels, sizeof(pixels)) == 0);
+
+    /* Keyframe arriving after the first tile of a full-screen change: the
+     * rest of that scan must not be sent as deltas against the cleared
+     * shadow, and the next update rebuilds the host copy from scratch */
+    change_all(1);
+    mock_uart_input("K", 1, mock_sdk.uartCount + 1);
+    host_clear_counts();
+    update(mirror, UNLIMITED);
+    TEST_EXPECT(host.tileCount == 1);
+    TEST_EXPECT(host.ends == 0);
+
+    host_clear_counts();
+    update(mirror, UNLIMITED);
+    TEST_EXPECT(host.infos == 1);
+    TEST_EXPECT(host.tileCount == TILES);
+    TEST_EXPECT(host.ends == 1);
+    TEST_EXPECT(memcmp(pixels, host.pixels, sizeof(pixels)) == 0);
+}
+
+static void test_flow_control(DisplayMirror &mirror) {
+    const char xoff = DISPLAYMIRROR_XOFF;
+    const char xon  = DISPLAYMIRROR_XON;
+
+    /* Nothing is sent while paused */
+    change_all(2);
+    mock_uart_input(&xoff, 1, mock_sdk.uartCount);
+    size_t before = mock_sdk.uartCount;
+    mirror.update(pixels, palette, UNLIMITED);
+    mirror.update(pixels, palette, UNLIMITED);
+    TEST_EXPECT(mock_sdk.uartCount == before);
+
+    mock_uart_input(&xon, 1, mock_sdk.uartCount);
+    host_clear_counts();
+    update(mirror, UNLIMITED);
+    TEST_EXPECT(host.tileCount == TILES);
+    TEST_EXPECT(host.ends == 1);
+    TEST_EXPECT(memcmp(pixels, host.pixels, sizeof(pixels)) == 0);
+
+    /* Pausing partway through a scan stops after the tile being sent, and
+     * resuming picks up the rest */
+    change_all(3);
+    mock_uart_input(&xoff, 1, mock_sdk.uartCount + 1);
+    host_clear_counts();
+    update(mirror, UNLIMITED);
+    TEST_EXPECT(host.tileCount == 1);
+
+    before = mock_sdk.uartCount;
+    mirror.update(pixels, palette, UNLIMITED);
+    TEST_EXPECT(mock_sdk.uartCount == before);
+
+    mock_uart_input(&xon, 1, mock_sdk.uartCount);
+    update(mirror, UNLIMITED);
+    update(mirror, UNLIMITED);
+    TEST_EXPECT(host.tileCount == TILES);
+    TEST_EXPECT(host.ends >= 1);
+    TEST_EXPECT(memcmp(pixels, host.pixels, sizeof(pixels)) == 0);
+}
+
+int main(void) {
+    mock_sdk_reset();
+
+    DisplayMirror mirror(UART_DEVICE_1, 921600, BPP, WIDTH, HEIGHT, shadow);
+    mirror.init();
+
+    /* Initial update has nothing but the header to send */
+    host_clear_counts();
+    update(mirror, UNLIMITED);
+    TEST_EXPECT(host.infos == 1);
+    TEST_EXPECT(host.ends == 1);
+
+    test_round_robin(mirror);
+    test_end_pending(mirror);
+    test_keyframe(mirror);
+    test_flow_control(mirror);
+
+    return test_result();
+}
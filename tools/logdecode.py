@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""
+Decode binary log frames emitted when LOG_BINARY is enabled in inc/log.hpp.
+
+Format strings are read from the LOG_FORMATS list in inc/log.hpp, so the
+firmware and decoder only need to be built from the same tree.
+
+Usage: logdecode.py [-f log.hpp] [input]
+  input defaults to stdin, and may be a serial device that has already been
+  configured (e.g. with stty).
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+SYNC = b'\xA5\x5A'
+HEADER = struct.Struct('<HBBI')
+MAX_ARGS = 6
+
+def load_formats(path):
+    formats = []
+    with open(path, 'r') as f:
+        for line in f:
+            m = re.match(r'\s*X\((\w+),\s*"((?:[^"\\]|\\.)*)"\)', line)
+            if m:
+                formats.append(m.group(2).encode().decode('unicode_escape'))
+    return formats
+
+def convert(fmt, args):
+    args = list(args)
+    def repl(m):
+        if m.group(0) == '%%':
+            return '%'
+        conv = m.group(3)
+        raw  = args.pop(0) if args else 0
+        spec = '%' + m.group(1) + conv
+        if conv in 'fFeEgGaA':
+            val = struct.unpack('<f', struct.pack('<I', raw))[0]
+        elif conv in 'di':
+            val = struct.unpack('<i', struct.pack('<I', raw))[0]
+            spec = '%' + m.group(1) + 'd'
+        else:
+            val = raw
+            if conv == 'u':
+                spec = '%' + m.group(1) + 'd'
+        return spec % val
+    return re.sub(r'%%|%([-+ #0-9.]*)(hh|h|ll|l|z|j|t|L)?([diouxXcfFeEgGaA])', repl, fmt)
+
+def decode(stream, formats):
+    buf = b''
+    while True:
+        data = stream.read(256)
+        if not data:
+            break
+        buf += data
+        while True:
+            idx = buf.find(SYNC)
+            if idx < 0:
+                # Keep last byte, it may be the start of a sync sequence
+                sys.stdout.write(buf[:-1].decode('ascii', 'replace'))
+                buf = buf[-1:]
+                break
+            if idx > 0:
+                # Anything outside a frame is printed as-is (e.g. plain printf output)
+                sys.stdout.write(buf[:idx].decode('ascii', 'replace'))
+            buf = buf[idx:]
+            if len(buf) < len(SYNC) + HEADER.size:
+                break
+            fmt, nargs, core, time = HEADER.unpack_from(buf, len(SYNC))
+            if nargs > MAX_ARGS:
+                buf = buf[1:]
+                continue
+            end = len(SYNC) + HEADER.size + (nargs * 4)
+            if len(buf) < end:
+                break
+            args = struct.unpack_from('<%dI' % nargs, buf, len(SYNC) + HEADER.size)
+            buf  = buf[end:]
+
+            text = convert(formats[fmt], args) if fmt < len(formats) else '<bad log format %d>' % fmt
+            print('[%d %10u] %s' % (core, time, text))
+        sys.stdout.flush()
+
+def main():
+    default = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'inc', 'log.hpp')
+    parser  = argparse.ArgumentParser(description='Decode binary log frames')
+    parser.add_argument('-f', '--formats', default=default, help='Path to log.hpp')
+    parser.add_argument('input', nargs='?', help='Input file or serial device')
+    args = parser.parse_args()
+
+    formats = load_formats(args.formats)
+    if args.input:
+        with open(args.input, 'rb', buffering=0) as stream:
+            decode(stream, formats)
+    else:
+        decode(sys.stdin.buffer, formats)
+
+if __name__ == '__main__':
+    main()
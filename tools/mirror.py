@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+"""
+Rebuild the display from the stream sent by DisplayMirror (src/DisplayMirror.cpp),
+writing a PPM image each time the device finishes sending a set of changes.
+
+Usage: mirror.py [-o outdir] [-k] input
+  input may be a capture file or a serial device that has already been
+  configured (e.g. with stty). With -k, a keyframe is requested on startup so
+  the display is complete even when connecting to a running device.
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+SYNC = b'\xA5\xC3'
+
+FRAME_INFO    = 0x01
+FRAME_PALETTE = 0x02
+FRAME_TILE    = 0x03
+FRAME_END     = 0x04
+
+def unpackbits(data, out_len):
+    out = bytearray()
+    i   = 0
+    while (i < len(data)) and (len(out) < out_len):
+        n = data[i]
+        i += 1
+        if n < 128:
+            out += data[i:i + n + 1]
+            i   += n + 1
+        elif n > 128:
+            out += bytes([data[i]]) * (257 - n)
+            i   += 1
+    return bytes(out)
+
+def color_to_rgb(c, color18):
+    if color18:
+        return ((c >> 16) & 0xFC, (c >> 8) & 0xFC, c & 0xFC)
+    return (((c >> 11) & 0x1F) << 3, ((c >> 5) & 0x3F) << 2, (c & 0x1F) << 3)
+
+class Mirror:
+    def __init__(self, outdir):
+        self.outdir  = outdir
+        self.frames  = 0
+        self.pixels  = None
+        self.palette = []
+
+    def info(self, payload):
+        self.width, self.height, self.bpp, self.tile, self.color18 = struct.unpack('<HHBBB', payload)
+        self.row_bytes  = (self.width * self.bpp + 7) // 8
+        self.tile_bytes = (self.tile * self.bpp) // 8
+        self.pixels     = bytearray(self.row_bytes * self.height)
+        self.palette    = [(0, 0, 0)] * (1 << self.bpp)
+
+    def set_palette(self, payload):
+        count,       = struct.unpack_from('<H', payload)
+        entries      = struct.unpack_from('<%dI' % count, payload, 2)
+        self.palette = [color_to_rgb(c, self.color18) for c in entries]
+
+    def apply_tile(self, payload):
+        tx, ty = struct.unpack_from('<HH', payload)
+        x0     = tx * self.tile_bytes
+        y0     = ty * self.tile
+        cols   = min(self.tile_bytes, self.row_bytes - x0)
+        rows   = min(self.tile, self.height - y0)
+        delta  = unpackbits(payload[4:], cols * rows)
+        for r in range(rows):
+            off = (y0 + r) * self.row_bytes + x0
+            for c in range(cols):
+                self.pixels[off + c] ^= delta[r * cols + c]
+
+    def write(self):
+        ppb  = 8 // self.bpp
+        mask = (1 << self.bpp) - 1
+        img  = bytearray()
+        for y in range(self.height):
+            row = self.pixels[y * self.row_bytes:(y + 1) * self.row_bytes]
+            for x in range(self.width):
+                shift = 8 - self.bpp * ((x % ppb) + 1)
+                img  += bytes(self.palette[(row[x // ppb] >> shift) & mask])
+        path = os.path.join(self.outdir, 'frame_%05d.ppm' % self.frames)
+        with open(path, 'wb') as f:
+            f.write(b'P6\n%d %d\n255\n' % (self.width, self.height))
+            f.write(img)
+        self.frames += 1
+        print(path)
+
+    def handle(self, ftype, payload):
+        if ftype == FRAME_INFO:
+            self.info(payload)
+        elif self.pixels is None:
+            # Joined mid-stream, wait for INFO
+            return
+        elif ftype == FRAME_PALETTE:
+            self.set_palette(payload)
+        elif ftype == FRAME_TILE:
+            self.apply_tile(payload)
+        elif ftype == FRAME_END:
+            self.write()
+
+def decode(stream, mirror):
+    buf = b''
+    while True:
+        data = stream.read(4096)
+        if not data:
+            break
+        buf += data
+        while True:
+            idx = buf.find(SYNC)
+            if idx < 0:
+                buf = buf[-1:]
+                break
+            buf = buf[idx:]
+            if len(buf) < 5:
+                break
+            ftype, length = struct.unpack_from('<BH', buf, 2)
+            if len(buf) < 5 + length + 1:
+                break
+            payload = buf[5:5 + length]
+            check   = ftype ^ (length & 0xFF) ^ (length >> 8)
+            for b in payload:
+                check ^= b
+            if check != buf[5 + length]:
+                sys.stderr.write('Bad checksum, resyncing\n')
+                buf = buf[1:]
+                continue
+            buf = buf[5 + length + 1:]
+            mirror.handle(ftype, payload)
+
+def main():
+    parser = argparse.ArgumentParser(description='Rebuild display from DisplayMirror stream')
+    parser.add_argument('-o', '--outdir', default='.', help='Directory to write frames to')
+    parser.add_argument('-k', '--keyframe', action='store_true', help='Request keyframe on startup')
+    parser.add_argument('input', help='Capture file or serial device')
+    args = parser.parse_args()
+
+    os.makedirs(args.outdir, exist_ok=True)
+    mirror = Mirror(args.outdir)
+
+    mode = 'r+b' if args.keyframe else 'rb'
+    with open(args.input, mode, buffering=0) as stream:
+        if args.keyframe:
+            stream.write(b'K')
+        decode(stream, mirror)
+
+if __name__ == '__main__':
+    main()